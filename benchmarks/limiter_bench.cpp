@@ -0,0 +1,110 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Compares the throughput of the scalar and AVX2 peak detectors over loud noise
+// at 48 kHz in 256-sample blocks. The detectors are timed on their own with
+// DetectPeaks(), then the whole limiter is timed with Process() so the share of
+// the detector in the total is visible.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "limiter.h"
+
+int main(int argc, char** argv)
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float sampleRate{48000.0f};
+    constexpr std::size_t blockSize{256};
+
+    const long seconds{(argc > 1) ? std::atol(argv[1]) : 60};
+    const std::size_t count{static_cast<std::size_t>(seconds) * static_cast<std::size_t>(sampleRate)};
+
+    std::vector<float> input(count);
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> noise{-1.0f, 1.0f};
+
+    for (float& sample : input)
+    {
+        sample = noise(random);
+    }
+
+    std::vector<float> output(count);
+
+    std::printf("%8s %16s %16s %14s\n", "path", "detect ns/sample", "total ns/sample", "x realtime");
+
+    for (const BrickwallLimiter::Path path : {BrickwallLimiter::Path::Scalar, BrickwallLimiter::Path::Avx2})
+    {
+        BrickwallLimiter limiter{};
+        limiter.Prepare(sampleRate, LimiterSettings{0.5f, 1.5f, 50.0f});
+        limiter.SetPath(path);
+
+        if (limiter.GetPath() != path)
+        {
+            std::printf("%8s %16s\n", "avx2", "unsupported");
+            continue;
+        }
+
+        // Peak detection only
+        Clock::time_point start{Clock::now()};
+
+        for (std::size_t i{0}; i < count; i += blockSize)
+        {
+            limiter.DetectPeaks(&input[i], &output[i], std::min(blockSize, count - i));
+        }
+
+        const double detectElapsed{std::chrono::duration<double>(Clock::now() - start).count()};
+
+        // The whole limiter
+        limiter.Reset();
+        start = Clock::now();
+
+        for (std::size_t i{0}; i < count; i += blockSize)
+        {
+            limiter.Process(&input[i], &output[i], std::min(blockSize, count - i));
+        }
+
+        const double elapsed{std::chrono::duration<double>(Clock::now() - start).count()};
+
+        float peak{0.0f};
+
+        for (const float sample : output)
+        {
+            peak = std::max(peak, std::fabs(sample));
+        }
+
+        if (peak > 0.5f)
+        {
+            std::fprintf(stderr, "output over the ceiling: %f\n", peak);
+            return 1;
+        }
+
+        const double samples{static_cast<double>(count)};
+
+        std::printf("%8s %16.2f %16.2f %14.1f\n", (path == BrickwallLimiter::Path::Avx2) ? "avx2" : "scalar", detectElapsed * 1e9 / samples, elapsed * 1e9 / samples, static_cast<double>(seconds) / elapsed);
+    }
+
+    return 0;
+}
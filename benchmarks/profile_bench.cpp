@@ -0,0 +1,126 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Applies profiles to a simulated system with 5000 endpoints and 5000 sessions
+// and reports the writes each apply issues and how long it takes, including
+// an apply whose write 700 fails and is rolled back.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "profile.h"
+
+constexpr int endpointCount{5000};
+constexpr int sessionCount{5000};
+
+static AudioState MakeState()
+{
+    AudioState state{};
+
+    for (int i{0}; i < endpointCount; ++i)
+    {
+        state.endpoints.push_back(EndpointState{"endpoint-" + std::to_string(i), 0.5f, false});
+    }
+
+    for (int i{0}; i < sessionCount; ++i)
+    {
+        state.sessions.push_back(SessionState{"session-" + std::to_string(i), 1.0f});
+    }
+
+    return state;
+}
+
+// Change every stride-th level, mute and cap, and lock the volume
+static AudioState Change(AudioState state, int stride)
+{
+    for (std::size_t i{0}; i < state.endpoints.size(); i += static_cast<std::size_t>(stride))
+    {
+        state.endpoints[i].level = 0.2f;
+        state.endpoints[i].muted = true;
+    }
+
+    for (std::size_t i{0}; i < state.sessions.size(); i += static_cast<std::size_t>(stride))
+    {
+        state.sessions[i].cap = 0.5f;
+    }
+
+    state.isVolumeLocked = true;
+
+    return state;
+}
+
+struct Scenario
+{
+    const char* name;
+    AudioProfile profile;
+
+    // Index of the write that fails, -1 for none
+    long failAt;
+};
+
+int main(int argc, char** argv)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const int repetitions{(argc > 1) ? std::atoi(argv[1]) : 20};
+
+    const AudioState initial{MakeState()};
+
+    const Scenario scenarios[]
+    {
+        {"unchanged", AudioProfile{"unchanged", initial}, -1},
+        {"10% changed", AudioProfile{"sparse", Change(initial, 10)}, -1},
+        {"all changed", AudioProfile{"dense", Change(initial, 1)}, -1},
+        {"fail at 700", AudioProfile{"sparse", Change(initial, 10)}, 700},
+    };
+
+    std::printf("%12s %10s %12s %12s\n", "profile", "writes", "rolled back", "us/apply");
+
+    for (const Scenario& scenario : scenarios)
+    {
+        ApplyResult result{};
+        double totalUs{0.0};
+
+        for (int i{0}; i < repetitions; ++i)
+        {
+            SimulatedAudioBackend backend{initial};
+            backend.FailWriteAt(scenario.failAt);
+
+            const Clock::time_point start{Clock::now()};
+            result = ApplyProfile(backend, scenario.profile);
+            totalUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            // The backend must end up in the target state, or back in the initial one
+            AudioState expected{(scenario.failAt < 0) ? scenario.profile.state : initial};
+            SortAudioState(expected);
+
+            if (result.succeeded != (scenario.failAt < 0) || result.rollbackFailures != 0 || !DiffAudioState(backend.GetState(), expected).empty())
+            {
+                std::fprintf(stderr, "%s: unexpected state after apply\n", scenario.name);
+                return 1;
+            }
+        }
+
+        std::printf("%12s %10zu %12zu %12.1f\n", scenario.name, result.writesIssued, result.writesRolledBack, totalUs / repetitions);
+    }
+
+    return 0;
+}
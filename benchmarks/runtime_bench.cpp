@@ -0,0 +1,123 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Measures the runtime's suspend/resume cost and how late timers fire when
+// thousands of them are pending at once.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "runtime.h"
+
+using namespace std::chrono_literals;
+
+static Task RescheduleLoop(Runtime& runtime, long iterations, long& resumes)
+{
+    for (long i{0}; i < iterations; ++i)
+    {
+        co_await runtime.Reschedule();
+        ++resumes;
+    }
+
+    runtime.Stop();
+}
+
+static Task SleepAndMeasure(Runtime& runtime, Runtime::Clock::time_point deadline, double& lateness)
+{
+    co_await runtime.SleepUntil(deadline);
+    lateness = std::chrono::duration<double, std::micro>(Runtime::Clock::now() - deadline).count();
+}
+
+static Task StopAt(Runtime& runtime, Runtime::Clock::time_point deadline)
+{
+    co_await runtime.SleepUntil(deadline);
+    runtime.Stop();
+}
+
+int main(int argc, char** argv)
+{
+    using Clock = Runtime::Clock;
+
+    const long iterations{(argc > 1) ? std::atol(argv[1]) : 1000000};
+
+    // Suspend/resume round trips through the ready queue
+    {
+        Runtime runtime{};
+        long resumes{0};
+
+        const Clock::time_point start{Clock::now()};
+        Task task{RescheduleLoop(runtime, iterations, resumes)};
+        runtime.Run();
+        const double ns{std::chrono::duration<double, std::nano>(Clock::now() - start).count()};
+
+        std::printf("suspend/resume: %ld round trips, %.1f ns each\n\n", resumes, ns / static_cast<double>(resumes));
+
+        if (resumes != iterations)
+        {
+            std::fprintf(stderr, "unexpected resume count\n");
+            return 1;
+        }
+    }
+
+    // Timers spread evenly over 200 ms
+    const int timerCounts[]{1000, 5000, 10000};
+    const auto spread{200ms};
+
+    std::printf("%8s %12s %12s %12s %12s\n", "timers", "mean us", "p50 us", "p99 us", "max us");
+
+    for (const int count : timerCounts)
+    {
+        Runtime runtime{};
+        std::vector<double> lateness(static_cast<std::size_t>(count), -1.0);
+        std::vector<Task> tasks{};
+        tasks.reserve(static_cast<std::size_t>(count) + 1);
+
+        const Clock::time_point start{Clock::now() + 10ms};
+
+        for (int i{0}; i < count; ++i)
+        {
+            tasks.push_back(SleepAndMeasure(runtime, start + spread * i / count, lateness[static_cast<std::size_t>(i)]));
+        }
+
+        tasks.push_back(StopAt(runtime, start + spread + 10ms));
+        runtime.Run();
+
+        if (std::any_of(lateness.begin(), lateness.end(), [](double value) { return value < 0.0; }))
+        {
+            std::fprintf(stderr, "a timer fired early or never fired\n");
+            return 1;
+        }
+
+        double sum{0.0};
+
+        for (const double value : lateness)
+        {
+            sum += value;
+        }
+
+        std::sort(lateness.begin(), lateness.end());
+
+        std::printf("%8d %12.1f %12.1f %12.1f %12.1f\n", count, sum / count, lateness[lateness.size() / 2], lateness[lateness.size() * 99 / 100], lateness.back());
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Feeds SliderInput synthetic drag streams at rates far above what a trackbar
+// produces and reports the cost per notification and how many notifications
+// were folded into each backend write.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "slider_input.h"
+
+int main(int argc, char** argv)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Drag notifications per 10 ms frame
+    const int rates[]{1, 10, 100, 1000};
+
+    const long frames{(argc > 1) ? std::atol(argv[1]) : 100000};
+
+    std::printf("%12s %14s %14s %16s\n", "per frame", "notifications", "writes", "ns/notification");
+
+    for (const int rate : rates)
+    {
+        SliderInput input{};
+        long notifications{0};
+        long writes{0};
+        float volume{};
+        float sink{0.0f};
+
+        const Clock::time_point start{Clock::now()};
+
+        for (long frame{0}; frame < frames; ++frame)
+        {
+            // A drag sweeping back and forth across the slider
+            for (int i{0}; i < rate; ++i)
+            {
+                input.OnThumbTrack(static_cast<int>((frame * rate + i) % 201) - 50);
+                ++notifications;
+            }
+
+            if (frame % 50 == 49)
+            {
+                input.OnEndTrack(static_cast<int>(frame % 101));
+                ++notifications;
+            }
+
+            if (input.TakePendingWrite(volume))
+            {
+                ++writes;
+                sink += volume;
+            }
+        }
+
+        const double ns{std::chrono::duration<double, std::nano>(Clock::now() - start).count()};
+
+        std::printf("%12d %14ld %14ld %16.2f\n", rate, notifications, writes, ns / static_cast<double>(notifications));
+
+        // Every frame had input, so there is exactly one write per frame
+        if (writes != frames || static_cast<long>(input.GetCoalescedCount()) != notifications - writes || sink < 0.0f)
+        {
+            std::fprintf(stderr, "unexpected write count\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// LADSPA wrapper around BrickwallLimiter, one instance per channel, so it can
+// be loaded by PipeWire's filter-chain. The "Max Volume" control takes the
+// same 0 - 100 value as the app's Max Volume textbox. It is set in the
+// filter-chain config, the plugin doesn't read the app's setting.
+
+#include <new>
+#include <ladspa.h>
+#include "limiter.h"
+
+// Port indices
+enum : unsigned long
+{
+    portInput,
+    portOutput,
+    portMaxVolume,
+    portRelease,
+    portLatency,
+    portCount
+};
+
+struct LimiterInstance
+{
+    BrickwallLimiter limiter{};
+    float sampleRate{48000.0f};
+
+    // Connected port buffers
+    LADSPA_Data* ports[portCount]{};
+
+    // Last control values applied to the limiter
+    float maxVolume{-1.0f};
+    float release{-1.0f};
+};
+
+static LADSPA_Handle Instantiate(const LADSPA_Descriptor*, unsigned long sampleRate)
+{
+    // Allocation happens here, never in Run
+    LimiterInstance* const instance{new (std::nothrow) LimiterInstance{}};
+
+    if (instance != nullptr)
+    {
+        instance->sampleRate = static_cast<float>(sampleRate);
+        instance->limiter.Prepare(instance->sampleRate, LimiterSettings{});
+    }
+
+    return instance;
+}
+
+static void ConnectPort(LADSPA_Handle handle, unsigned long port, LADSPA_Data* data)
+{
+    if (port < portCount)
+    {
+        static_cast<LimiterInstance*>(handle)->ports[port] = data;
+    }
+}
+
+static void Activate(LADSPA_Handle handle)
+{
+    LimiterInstance* const instance{static_cast<LimiterInstance*>(handle)};
+
+    instance->limiter.Reset();
+}
+
+static void Run(LADSPA_Handle handle, unsigned long sampleCount)
+{
+    LimiterInstance* const instance{static_cast<LimiterInstance*>(handle)};
+
+    // Apply control changes
+    const float maxVolume{*instance->ports[portMaxVolume]};
+
+    if (maxVolume != instance->maxVolume)
+    {
+        instance->maxVolume = maxVolume;
+        instance->limiter.SetCeiling(LimiterCeilingFromMaxVolume(maxVolume / 100.0f));
+    }
+
+    const float release{*instance->ports[portRelease]};
+
+    if (release != instance->release)
+    {
+        instance->release = release;
+        instance->limiter.SetRelease(release);
+    }
+
+    instance->limiter.Process(instance->ports[portInput], instance->ports[portOutput], sampleCount);
+
+    // Report the delay so the host can compensate
+    if (instance->ports[portLatency] != nullptr)
+    {
+        *instance->ports[portLatency] = static_cast<LADSPA_Data>(instance->limiter.GetLatency());
+    }
+}
+
+static void Cleanup(LADSPA_Handle handle)
+{
+    delete static_cast<LimiterInstance*>(handle);
+}
+
+static const LADSPA_PortDescriptor portDescriptors[portCount]
+{
+    LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+    LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+    LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+    LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL,
+    LADSPA_PORT_OUTPUT | LADSPA_PORT_CONTROL,
+};
+
+static const char* const portNames[portCount]
+{
+    "Input",
+    "Output",
+    "Max Volume",
+    "Release (ms)",
+    "latency",
+};
+
+static const LADSPA_PortRangeHint portRangeHints[portCount]
+{
+    {0, 0.0f, 0.0f},
+    {0, 0.0f, 0.0f},
+    {LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_MAXIMUM, 0.0f, 100.0f},
+    // Logarithmic middle of 5 - 500 ms is 50 ms, LimiterSettings::releaseMs
+    {LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_LOGARITHMIC | LADSPA_HINT_DEFAULT_MIDDLE, 5.0f, 500.0f},
+    {0, 0.0f, 0.0f},
+};
+
+static const LADSPA_Descriptor descriptor
+{
+    4761,                                   // UniqueID
+    "vcp_brickwall_limiter",                // Label
+    LADSPA_PROPERTY_HARD_RT_CAPABLE,        // Properties
+    "Volume Control Plus Brickwall Limiter",// Name
+    "Wildan R Wijanarko",                   // Maker
+    "MIT",                                  // Copyright
+    portCount,
+    portDescriptors,
+    portNames,
+    portRangeHints,
+    nullptr,                                // ImplementationData
+    Instantiate,
+    ConnectPort,
+    Activate,
+    Run,
+    nullptr,                                // run_adding
+    nullptr,                                // set_run_adding_gain
+    nullptr,                                // deactivate
+    Cleanup,
+};
+
+extern "C" __attribute__((visibility("default"))) const LADSPA_Descriptor* ladspa_descriptor(unsigned long index)
+{
+    return (index == 0) ? &descriptor : nullptr;
+}
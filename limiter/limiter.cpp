@@ -0,0 +1,318 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "limiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+// The AVX2 detector is compiled with a target attribute and picked at runtime,
+// so the library still loads on CPUs without AVX2
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VCP_LIMITER_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+BrickwallLimiter::BrickwallLimiter()
+{
+    Prepare(sampleRate, LimiterSettings{});
+}
+
+void BrickwallLimiter::Prepare(float rate, const LimiterSettings& settings)
+{
+    constexpr double pi{3.14159265358979323846};
+
+    sampleRate = rate;
+    SetCeiling(settings.ceiling);
+
+    // Lookahead window in samples
+    const long window{std::lround(settings.lookaheadMs * sampleRate / 1000.0f)};
+    lookahead = static_cast<std::size_t>(std::clamp<long>(window, 1, static_cast<long>(maxLookahead)));
+
+    // The gain is held and averaged over lookahead samples and the detector lags by detectorDelay
+    latency = lookahead - 1 + detectorDelay;
+
+    SetRelease(settings.releaseMs);
+
+    // Blackman-windowed sinc for the fractional positions inside the center interval
+    constexpr double half{static_cast<double>(taps) / 2.0};
+
+    for (std::size_t p{0}; p < oversampling - 1; ++p)
+    {
+        const double fraction{static_cast<double>(p + 1) / oversampling};
+        double sum{0.0};
+
+        for (std::size_t k{0}; k < taps; ++k)
+        {
+            const double d{static_cast<double>(center) + fraction - static_cast<double>(k)};
+            const double sinc{std::sin(pi * d) / (pi * d)};
+            const double blackman{0.42 + 0.5 * std::cos(pi * d / half) + 0.08 * std::cos(2.0 * pi * d / half)};
+
+            phases[p][k] = static_cast<float>(sinc * blackman);
+            sum += sinc * blackman;
+        }
+
+        // Unity gain at DC
+        for (float& c : phases[p])
+        {
+            c = static_cast<float>(c / sum);
+        }
+    }
+
+    SetPath(IsAvx2Supported() ? Path::Avx2 : Path::Scalar);
+
+    Reset();
+}
+
+void BrickwallLimiter::SetCeiling(float value)
+{
+    ceiling = std::max(value, 0.0f);
+}
+
+void BrickwallLimiter::SetRelease(float releaseMs)
+{
+    const float samples{std::max(releaseMs * sampleRate / 1000.0f, 1.0f)};
+    releaseCoef = 1.0f - std::exp(-1.0f / samples);
+}
+
+void BrickwallLimiter::Reset()
+{
+    history.fill(0.0f);
+    delayLine.fill(0.0f);
+    delayPos = 0;
+
+    minHead   = 0;
+    minTail   = 0;
+    gainIndex = 0;
+
+    envelope = 1.0f;
+    clampCount = 0;
+
+    // The moving average starts at unity gain
+    std::fill(average.begin(), average.begin() + lookahead, 1.0f);
+    averagePos = 0;
+    averageSum = static_cast<double>(lookahead);
+}
+
+void BrickwallLimiter::SetPath(Path value)
+{
+    path = (value == Path::Avx2 && IsAvx2Supported()) ? Path::Avx2 : Path::Scalar;
+}
+
+bool BrickwallLimiter::IsAvx2Supported()
+{
+#ifdef VCP_LIMITER_HAS_AVX2
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+void BrickwallLimiter::Process(const float* in, float* out, std::size_t count)
+{
+    while (count > 0)
+    {
+        const std::size_t n{std::min(count, chunkSize)};
+
+        ProcessChunk(in, out, n);
+
+        in    += n;
+        out   += n;
+        count -= n;
+    }
+}
+
+void BrickwallLimiter::DetectPeaks(const float* in, float* peaks, std::size_t count)
+{
+    while (count > 0)
+    {
+        const std::size_t n{std::min(count, chunkSize)};
+
+        PushHistory(in, n);
+        DetectChunk(n);
+        std::copy(peak.begin(), peak.begin() + n, peaks);
+        PopHistory(n);
+
+        in    += n;
+        peaks += n;
+        count -= n;
+    }
+}
+
+void BrickwallLimiter::PushHistory(const float* in, std::size_t count)
+{
+    // Append the chunk after the kept taps - 1 samples
+    std::copy(in, in + count, history.begin() + (taps - 1));
+}
+
+void BrickwallLimiter::PopHistory(std::size_t count)
+{
+    // Keep the last taps - 1 samples for the next chunk
+    std::copy(history.begin() + count, history.begin() + count + (taps - 1), history.begin());
+}
+
+void BrickwallLimiter::DetectChunk(std::size_t count)
+{
+    if (path == Path::Avx2)
+    {
+        DetectPeaksAvx2(count);
+    }
+    else
+    {
+        DetectPeaksScalar(count);
+    }
+}
+
+void BrickwallLimiter::ProcessChunk(const float* in, float* out, std::size_t count)
+{
+    constexpr std::size_t keep{taps - 1};
+
+    PushHistory(in, count);
+    DetectChunk(count);
+
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        // Gain needed to bring this interval under the ceiling, shaved by about
+        // 0.0001 dB so rounding in the averaged gain can't land above it
+        const float required{(peak[i] > ceiling) ? ceiling / peak[i] * 0.99999f : 1.0f};
+
+        // Sliding minimum over the lookahead window
+        while (minTail != minHead && minValue[(minTail - 1) & ringMask] >= required)
+        {
+            --minTail;
+        }
+
+        minValue[minTail & ringMask] = required;
+        minIndex[minTail & ringMask] = gainIndex;
+        ++minTail;
+
+        if (minIndex[minHead & ringMask] + lookahead <= gainIndex)
+        {
+            ++minHead;
+        }
+
+        ++gainIndex;
+
+        const float held{minValue[minHead & ringMask]};
+
+        // Attack instantly, release exponentially; never above the held gain
+        envelope = (held < envelope) ? held : envelope + (held - envelope) * releaseCoef;
+
+        // Smooth the attack with a moving average over the lookahead window
+        averageSum += envelope - average[averagePos];
+        average[averagePos] = envelope;
+
+        if (++averagePos == lookahead)
+        {
+            averagePos = 0;
+        }
+
+        gain[i] = static_cast<float>(averageSum / static_cast<double>(lookahead));
+
+        // Delay the audio so the gain lines up with the peak
+        delayLine[delayPos] = history[keep + i];
+        delayed[i] = delayLine[(delayPos - latency) & ringMask];
+        delayPos = (delayPos + 1) & ringMask;
+    }
+
+    // The clamp is a safety net, the gain already keeps the samples under the ceiling
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        const float sample{delayed[i] * gain[i]};
+
+        out[i] = std::clamp(sample, -ceiling, ceiling);
+        clampCount += (out[i] != sample) ? 1 : 0;
+    }
+
+    PopHistory(count);
+}
+
+void BrickwallLimiter::DetectPeaksScalar(std::size_t count)
+{
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        // The window for sample n is history[i..i + taps - 1], ending at x[n]
+        const float* const x{&history[i]};
+
+        float m{std::max(std::fabs(x[center]), std::fabs(x[center + 1]))};
+
+        for (const std::array<float, taps>& c : phases)
+        {
+            float s{0.0f};
+
+            for (std::size_t k{0}; k < taps; ++k)
+            {
+                s += c[k] * x[k];
+            }
+
+            m = std::max(m, std::fabs(s));
+        }
+
+        peak[i] = m;
+    }
+}
+
+#ifdef VCP_LIMITER_HAS_AVX2
+
+// Computes 8 consecutive samples per iteration, one coefficient broadcast per tap.
+// history is padded, so a partial last group stays in bounds and its extra lanes are dropped.
+__attribute__((target("avx2,fma"))) void BrickwallLimiter::DetectPeaksAvx2(std::size_t count)
+{
+    const __m256 signMask{_mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))};
+
+    for (std::size_t i{0}; i < count; i += 8)
+    {
+        const float* const x{&history[i]};
+
+        __m256 m{_mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(x + center), signMask), _mm256_and_ps(_mm256_loadu_ps(x + center + 1), signMask))};
+
+        for (const std::array<float, taps>& c : phases)
+        {
+            __m256 s{_mm256_mul_ps(_mm256_set1_ps(c[0]), _mm256_loadu_ps(x))};
+
+            for (std::size_t k{1}; k < taps; ++k)
+            {
+                s = _mm256_fmadd_ps(_mm256_set1_ps(c[k]), _mm256_loadu_ps(x + k), s);
+            }
+
+            m = _mm256_max_ps(m, _mm256_and_ps(s, signMask));
+        }
+
+        if (i + 8 <= count)
+        {
+            _mm256_storeu_ps(&peak[i], m);
+        }
+        else
+        {
+            alignas(32) float lanes[8];
+            _mm256_store_ps(lanes, m);
+            std::copy(lanes, lanes + (count - i), &peak[i]);
+        }
+    }
+}
+
+#else
+
+void BrickwallLimiter::DetectPeaksAvx2(std::size_t count)
+{
+    DetectPeaksScalar(count);
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+// Max volume is a 0.0 - 1.0 slider position, the same value as the app's Max
+// Volume box divided by 100. Slider positions are audio tapered, so it is
+// mapped to a linear amplitude with the cubic curve PipeWire and PulseAudio use
+// for their volume sliders: 1.0 is 0 dBFS, 0.8 about -5.8 dB, 0.5 about -18 dB.
+inline float LimiterCeilingFromMaxVolume(float maxVolume)
+{
+    if (maxVolume < 0.0f) return 0.0f;
+    if (maxVolume > 1.0f) return 1.0f;
+
+    return maxVolume * maxVolume * maxVolume;
+}
+
+struct LimiterSettings
+{
+    // Linear peak ceiling, see LimiterCeilingFromMaxVolume
+    float ceiling{1.0f};
+
+    // How far ahead gain reduction starts, this sets the latency
+    float lookaheadMs{1.5f};
+
+    // Time constant for the gain to recover after a peak
+    float releaseMs{50.0f};
+};
+
+// Single-channel oversampled-peak brickwall limiter.
+//
+// Peaks are detected on an 8x oversampled signal (32-tap polyphase
+// windowed-sinc interpolation, AVX2 when the CPU has it), the required gain is
+// held for the lookahead window, released exponentially and then smoothed with
+// a moving average over the same window. The audio is delayed so that the
+// smoothed gain reaches its target when the peak comes out, which keeps every
+// output sample at or below the ceiling.
+//
+// The output true peak (inter-sample peaks included) stays within 0.15 dB of
+// the ceiling for material below 20 kHz. Full-band noise near Nyquist needs a
+// longer interpolator than this and can go about 1 dB over, so this is not a
+// certified true-peak limiter.
+//
+// All state lives in fixed-size members, Process() never allocates.
+class BrickwallLimiter
+{
+public:
+    enum class Path { Scalar, Avx2 };
+
+    // Upper bound on the lookahead window in samples (about 5 ms at 96 kHz)
+    static constexpr std::size_t maxLookahead{512};
+
+    BrickwallLimiter();
+
+    // Configure for a sample rate and reset the state
+    void Prepare(float sampleRate, const LimiterSettings& settings);
+
+    void SetCeiling(float ceiling);
+    void SetRelease(float releaseMs);
+
+    // Clear the delay line and gain state without changing the settings
+    void Reset();
+
+    // Process count samples, in and out may point to the same buffer
+    void Process(const float* in, float* out, std::size_t count);
+
+    // Run only the peak detector: write the oversampled peak of each input
+    // interval to peaks, delayed by the detector's taps / 2 samples. It shares
+    // the input history with Process(), so Reset() before switching between them.
+    void DetectPeaks(const float* in, float* peaks, std::size_t count);
+
+    // Delay introduced by Process() in samples
+    std::size_t GetLatency() const { return latency; }
+
+    // Output samples the final clamp to +-ceiling had to change since Reset().
+    // The gain keeps the output under the ceiling, so this stays 0.
+    std::size_t GetClampCount() const { return clampCount; }
+
+    // Pick the peak detector implementation, Avx2 falls back to Scalar if unsupported
+    void SetPath(Path path);
+    Path GetPath() const { return path; }
+
+    static bool IsAvx2Supported();
+
+private:
+    // Oversampling factor and interpolator taps per phase
+    static constexpr std::size_t oversampling{8};
+    static constexpr std::size_t taps{32};
+
+    // Samples processed per inner iteration, a multiple of the AVX2 width
+    static constexpr std::size_t chunkSize{64};
+
+    // Ring buffers are a power of two so the index can be masked
+    static constexpr std::size_t ringSize{1024};
+    static constexpr std::size_t ringMask{ringSize - 1};
+
+    // The interpolated interval is history[center]..history[center + 1] of each window
+    static constexpr std::size_t center{taps / 2 - 1};
+
+    // Interpolator delay: the peak of the interval ending at x[n - center] is known at sample n
+    static constexpr std::size_t detectorDelay{taps / 2};
+
+    void ProcessChunk(const float* in, float* out, std::size_t count);
+
+    // Append a chunk to the history, and shift the history once it is consumed
+    void PushHistory(const float* in, std::size_t count);
+    void PopHistory(std::size_t count);
+
+    // Write the oversampled peak of each interval into peak[0..count) with the selected path
+    void DetectChunk(std::size_t count);
+
+    void DetectPeaksScalar(std::size_t count);
+    void DetectPeaksAvx2(std::size_t count);
+
+    float sampleRate{48000.0f};
+    float ceiling{1.0f};
+    float releaseCoef{1.0f};
+
+    std::size_t lookahead{1};
+    std::size_t latency{0};
+    std::size_t clampCount{0};
+
+    Path path{Path::Scalar};
+
+    // Interpolation coefficients for the fractional phases 1/8 to 7/8
+    alignas(32) std::array<std::array<float, taps>, oversampling - 1> phases{};
+
+    // Input history: taps - 1 previous samples followed by the current chunk
+    alignas(32) std::array<float, taps - 1 + chunkSize + 8> history{};
+
+    alignas(32) std::array<float, chunkSize> peak{};
+    alignas(32) std::array<float, chunkSize> gain{};
+    alignas(32) std::array<float, chunkSize> delayed{};
+
+    // Audio delay line
+    std::array<float, ringSize> delayLine{};
+    std::size_t delayPos{0};
+
+    // Monotonic queue for the sliding minimum of the required gain
+    std::array<float, ringSize> minValue{};
+    std::array<std::size_t, ringSize> minIndex{};
+    std::size_t minHead{0};
+    std::size_t minTail{0};
+    std::size_t gainIndex{0};
+
+    // Release envelope
+    float envelope{1.0f};
+
+    // Moving average of the released gain
+    std::array<float, ringSize> average{};
+    std::size_t averagePos{0};
+    double averageSum{0.0};
+};
@@ -0,0 +1,157 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Built with VCP_MINIMAL_FOOTPRINT: drives the runtime and the slider input the
+// way the enforcement loop does and checks that a steady-state pass doesn't
+// allocate, that saving and applying profiles doesn't either once the scratch
+// storage has grown, and that the process stays within the footprint budget.
+
+#include <chrono>
+#include <cstddef>
+#include "check.h"
+#include "footprint.h"
+#include "profile.h"
+#include "runtime.h"
+#include "slider_input.h"
+
+using namespace std::chrono_literals;
+
+constexpr int passCount{200};
+
+struct PassStats
+{
+    // Passes whose body allocated, the first one included
+    int allocatingPasses{0};
+
+    // Allocations between the end of the first pass and the last one, including the awaits
+    std::size_t steadyAllocations{0};
+};
+
+// Same shape as the enforcement loop in main.cpp
+static Task EnforcementLoop(Runtime& runtime, SliderInput& input, PassStats& stats)
+{
+    std::size_t afterFirstPass{0};
+    float volume{0.5f};
+
+    for (int pass{0}; pass < passCount; ++pass)
+    {
+        const AllocationProbe probe{};
+
+        input.OnThumbTrack(pass % 101);
+
+        if (pass % 10 == 9)
+        {
+            input.OnEndTrack(pass % 101);
+        }
+
+        if (!input.TakePendingWrite(volume) && input.FollowsSystem())
+        {
+            volume = 0.5f;
+        }
+
+        if (probe.GetAllocations() != 0)
+        {
+            ++stats.allocatingPasses;
+        }
+
+        if (pass == 0)
+        {
+            afterFirstPass = GetThreadAllocationCount();
+        }
+
+        co_await runtime.SleepFor(100us);
+    }
+
+    stats.steadyAllocations = GetThreadAllocationCount() - afterFirstPass;
+    runtime.Stop();
+}
+
+static void TestEnforcementLoopDoesNotAllocate()
+{
+    Runtime runtime{};
+    SliderInput input{};
+    PassStats stats{};
+
+    {
+        const Task task{EnforcementLoop(runtime, input, stats)};
+        runtime.Run();
+    }
+
+    CHECK(stats.allocatingPasses == 0);
+    CHECK(stats.steadyAllocations == 0);
+}
+
+// Saving and applying profiles reuses the profile and scratch storage. The
+// ids are longer than the small string buffer, like Windows endpoint ids.
+static void TestProfilesDoNotAllocate()
+{
+    const auto makeState{[](float level, bool muted, float cap)
+    {
+        AudioState state{};
+        state.endpoints = {EndpointState{"{0.0.0.00000000}.{speakers-endpoint}", level, muted}, EndpointState{"{0.0.0.00000000}.{headphones-endpoint}", level, false}};
+        state.sessions  = {SessionState{"{browser-audio-session-identifier}", cap}, SessionState{"{player-audio-session-identifier}", cap}};
+
+        return state;
+    }};
+
+    SimulatedAudioBackend backend{makeState(0.5f, false, 1.0f)};
+    AudioProfile lecture{"Lecture", makeState(0.3f, false, 0.5f)};
+    AudioProfile exam{"Exam", makeState(0.0f, true, 0.0f)};
+    AudioProfile saved{"Saved", {}};
+    ApplyScratch scratch{};
+
+    // The first round grows the scratch storage and the saved profile
+    CHECK(ApplyProfile(backend, lecture, scratch).succeeded);
+    CHECK(ApplyProfile(backend, exam, scratch).succeeded);
+    backend.Read(saved.state);
+
+    const AllocationProbe probe{};
+
+    for (int i{0}; i < passCount; ++i)
+    {
+        CHECK(ApplyProfile(backend, (i % 2 == 0) ? lecture : exam, scratch).writesIssued > 0);
+        backend.Read(saved.state);
+    }
+
+    CHECK(probe.GetAllocations() == 0);
+}
+
+// The probe only sees allocations made while it is in scope
+static void TestProbeCountsAllocations()
+{
+    const AllocationProbe probe{};
+    CHECK(probe.GetAllocations() == 0);
+
+    delete new int{1};
+    CHECK(probe.GetAllocations() == 1);
+}
+
+int main()
+{
+    TestEnforcementLoopDoesNotAllocate();
+    TestProfilesDoNotAllocate();
+    TestProbeCountsAllocations();
+
+    CHECK(GetAllocationCount() > 0);
+    CHECK(GetPeakResidentBytes() > 0);
+    CHECK(IsWithinFootprintBudget());
+
+    return CheckResult();
+}
@@ -0,0 +1,510 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Offline tests for the brickwall limiter: test signals are written to WAV
+// files, read back, run through the limiter and the result is written and
+// read back again before it is checked, the way a file would be processed.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "limiter.h"
+
+constexpr float sampleRate{48000.0f};
+constexpr double pi{3.14159265358979323846};
+
+// Write a mono 32-bit float WAV file
+static bool WriteWav(const std::string& path, const std::vector<float>& samples)
+{
+    std::FILE* const file{std::fopen(path.c_str(), "wb")};
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const std::uint32_t dataBytes{static_cast<std::uint32_t>(samples.size() * sizeof(float))};
+    const std::uint32_t riffBytes{36 + dataBytes};
+    const std::uint32_t formatBytes{16};
+    const std::uint16_t format{3};
+    const std::uint16_t channels{1};
+    const std::uint32_t rate{static_cast<std::uint32_t>(sampleRate)};
+    const std::uint32_t byteRate{rate * sizeof(float)};
+    const std::uint16_t blockAlign{sizeof(float)};
+    const std::uint16_t bits{32};
+
+    // WAV is little endian, like every platform this is built for
+    std::fwrite("RIFF", 1, 4, file);
+    std::fwrite(&riffBytes, 4, 1, file);
+    std::fwrite("WAVEfmt ", 1, 8, file);
+    std::fwrite(&formatBytes, 4, 1, file);
+    std::fwrite(&format, 2, 1, file);
+    std::fwrite(&channels, 2, 1, file);
+    std::fwrite(&rate, 4, 1, file);
+    std::fwrite(&byteRate, 4, 1, file);
+    std::fwrite(&blockAlign, 2, 1, file);
+    std::fwrite(&bits, 2, 1, file);
+    std::fwrite("data", 1, 4, file);
+    std::fwrite(&dataBytes, 4, 1, file);
+
+    const bool isWritten{std::fwrite(samples.data(), sizeof(float), samples.size(), file) == samples.size()};
+
+    return std::fclose(file) == 0 && isWritten;
+}
+
+// Read a file written by WriteWav, returns an empty vector on error
+static std::vector<float> ReadWav(const std::string& path)
+{
+    std::vector<float> samples{};
+    std::FILE* const file{std::fopen(path.c_str(), "rb")};
+
+    if (file == nullptr)
+    {
+        return samples;
+    }
+
+    char header[44]{};
+
+    if (std::fread(header, 1, sizeof(header), file) == sizeof(header) && std::memcmp(header, "RIFF", 4) == 0 && std::memcmp(header + 36, "data", 4) == 0)
+    {
+        std::uint32_t dataBytes{};
+        std::memcpy(&dataBytes, header + 40, 4);
+
+        samples.resize(dataBytes / sizeof(float));
+
+        if (std::fread(samples.data(), sizeof(float), samples.size(), file) != samples.size())
+        {
+            samples.clear();
+        }
+    }
+
+    std::fclose(file);
+
+    return samples;
+}
+
+// Write the input to name.in.wav, process it from disk with the limiter and
+// return what was read back from name.out.wav
+static std::vector<float> ProcessFile(const std::string& name, const std::vector<float>& input, BrickwallLimiter& limiter, std::size_t blockSize)
+{
+    const std::string inPath{name + ".in.wav"};
+    const std::string outPath{name + ".out.wav"};
+
+    CHECK(WriteWav(inPath, input));
+
+    std::vector<float> samples{ReadWav(inPath)};
+    CHECK(samples.size() == input.size());
+
+    // Process in host-sized blocks, in place
+    for (std::size_t i{0}; i < samples.size(); i += blockSize)
+    {
+        limiter.Process(&samples[i], &samples[i], std::min(blockSize, samples.size() - i));
+    }
+
+    CHECK(WriteWav(outPath, samples));
+
+    std::vector<float> output{ReadWav(outPath)};
+    CHECK(output.size() == input.size());
+
+    std::remove(inPath.c_str());
+    std::remove(outPath.c_str());
+
+    return output;
+}
+
+static float Peak(const std::vector<float>& samples)
+{
+    float peak{0.0f};
+
+    for (const float sample : samples)
+    {
+        peak = std::max(peak, std::fabs(sample));
+    }
+
+    return peak;
+}
+
+// Loud material: a sine 12 dB over the ceiling with bursts of full-scale noise
+static std::vector<float> LoudSignal(std::size_t count)
+{
+    std::vector<float> samples(count);
+    std::mt19937 random{1234};
+    std::uniform_real_distribution<float> noise{-1.0f, 1.0f};
+
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        samples[i] = 0.9f * static_cast<float>(std::sin(2.0 * pi * 997.0 * static_cast<double>(i) / sampleRate));
+
+        if ((i / 4800) % 3 == 1)
+        {
+            samples[i] = noise(random);
+        }
+    }
+
+    return samples;
+}
+
+// Isolated impulses over low noise. A single-sample peak is where rounding in
+// the averaged gain used to land the output over the ceiling.
+static std::vector<float> ImpulseSignal(std::size_t count)
+{
+    std::vector<float> samples(count);
+    std::mt19937 random{1};
+    std::uniform_real_distribution<float> noise{-0.1f, 0.1f};
+
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        samples[i] = (i % 997 == 0) ? 1.5f : noise(random);
+    }
+
+    return samples;
+}
+
+static void TestImpulsesStayUnderCeiling()
+{
+    const std::vector<float> input{ImpulseSignal(48000)};
+
+    for (const BrickwallLimiter::Path path : {BrickwallLimiter::Path::Scalar, BrickwallLimiter::Path::Avx2})
+    {
+        BrickwallLimiter limiter{};
+        limiter.Prepare(sampleRate, LimiterSettings{0.5f, 1.5f, 50.0f});
+        limiter.SetPath(path);
+
+        const std::vector<float> output{ProcessFile("limiter_test_impulses", input, limiter, 128)};
+
+        CHECK(Peak(output) <= 0.5f);
+
+        // The gain did the limiting, not the final clamp
+        CHECK(limiter.GetClampCount() == 0);
+    }
+}
+
+// No output sample goes over the ceiling, whatever the block size or path
+static void TestOutputStaysUnderCeiling()
+{
+    const std::vector<float> input{LoudSignal(48000)};
+    const std::size_t blockSizes[]{1, 64, 100, 1024};
+
+    for (const BrickwallLimiter::Path path : {BrickwallLimiter::Path::Scalar, BrickwallLimiter::Path::Avx2})
+    {
+        for (const std::size_t blockSize : blockSizes)
+        {
+            BrickwallLimiter limiter{};
+            limiter.Prepare(sampleRate, LimiterSettings{0.225f, 1.5f, 50.0f});
+            limiter.SetPath(path);
+
+            const std::vector<float> output{ProcessFile("limiter_test_ceiling", input, limiter, blockSize)};
+
+            CHECK(Peak(output) <= 0.225f);
+            CHECK(limiter.GetClampCount() == 0);
+
+            // The limiter reduces the level, it doesn't silence the signal
+            CHECK(Peak(output) > 0.2f);
+        }
+    }
+}
+
+// Reference true peak: 16x oversampling with a 128-tap windowed sinc per phase,
+// much longer than the limiter's own interpolator
+static float TruePeak(const std::vector<float>& samples)
+{
+    constexpr int phases{16};
+    constexpr int taps{128};
+    constexpr double half{taps / 2.0};
+
+    std::vector<double> coefficients(phases * taps);
+
+    for (int p{0}; p < phases; ++p)
+    {
+        double sum{0.0};
+
+        for (int k{0}; k < taps; ++k)
+        {
+            const double d{half - 1.0 + static_cast<double>(p) / phases - k};
+            const double sinc{(d == 0.0) ? 1.0 : std::sin(pi * d) / (pi * d)};
+            const double blackman{0.42 + 0.5 * std::cos(pi * d / half) + 0.08 * std::cos(2.0 * pi * d / half)};
+
+            coefficients[p * taps + k] = sinc * blackman;
+            sum += sinc * blackman;
+        }
+
+        for (int k{0}; k < taps; ++k)
+        {
+            coefficients[p * taps + k] /= sum;
+        }
+    }
+
+    double peak{0.0};
+
+    for (std::size_t n{0}; n + taps < samples.size(); ++n)
+    {
+        for (int p{0}; p < phases; ++p)
+        {
+            double s{0.0};
+
+            for (int k{0}; k < taps; ++k)
+            {
+                s += coefficients[p * taps + k] * samples[n + k];
+            }
+
+            peak = std::max(peak, std::fabs(s));
+        }
+    }
+
+    return static_cast<float>(peak);
+}
+
+// The sine and noise bursts of LoudSignal, with the noise band-limited to 20 kHz
+static std::vector<float> BandLimitedSignal(std::size_t count)
+{
+    constexpr int taps{255};
+    constexpr double cutoff{20000.0 / sampleRate};
+
+    std::vector<float> white(count + taps);
+    std::mt19937 random{99};
+    std::normal_distribution<float> noise{0.0f, 0.35f};
+
+    for (float& sample : white)
+    {
+        sample = noise(random);
+    }
+
+    std::vector<double> lowpass(taps);
+
+    for (int k{0}; k < taps; ++k)
+    {
+        const double d{k - (taps - 1) / 2.0};
+        const double sinc{(d == 0.0) ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * d) / (pi * d)};
+
+        lowpass[k] = sinc * (0.42 - 0.5 * std::cos(2.0 * pi * k / (taps - 1)) + 0.08 * std::cos(4.0 * pi * k / (taps - 1)));
+    }
+
+    std::vector<float> samples(count);
+
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        if ((i / 4800) % 3 == 1)
+        {
+            double sum{0.0};
+
+            for (int k{0}; k < taps; ++k)
+            {
+                sum += lowpass[k] * white[i + k];
+            }
+
+            samples[i] = static_cast<float>(sum);
+        }
+        else
+        {
+            samples[i] = 0.9f * static_cast<float>(std::sin(2.0 * pi * 997.0 * static_cast<double>(i) / sampleRate));
+        }
+    }
+
+    return samples;
+}
+
+// Sine at frequency (a fraction of the sample rate) faded in over 10 ms, so
+// the onset doesn't add inter-sample peaks of its own
+static std::vector<float> SineSignal(std::size_t count, double frequency, double phase)
+{
+    std::vector<float> samples(count);
+
+    for (std::size_t i{0}; i < count; ++i)
+    {
+        const double fade{std::min(1.0, static_cast<double>(i) / 480.0)};
+
+        samples[i] = static_cast<float>(fade * std::sin(2.0 * pi * frequency * static_cast<double>(i) + phase));
+    }
+
+    return samples;
+}
+
+// Inter-sample peaks of the output, measured with the reference interpolator
+static void TestOutputTruePeak()
+{
+    constexpr float ceiling{0.225f};
+
+    const auto limit{[](const std::vector<float>& input)
+    {
+        BrickwallLimiter limiter{};
+        limiter.Prepare(sampleRate, LimiterSettings{ceiling, 1.5f, 50.0f});
+
+        std::vector<float> output(input.size());
+        limiter.Process(input.data(), output.data(), input.size());
+
+        CHECK(limiter.GetClampCount() == 0);
+
+        return 20.0f * std::log10(TruePeak(output) / ceiling);
+    }};
+
+    // Material below 20 kHz stays within 0.15 dB of the ceiling
+    const float bandLimited{limit(BandLimitedSignal(24000))};
+    std::printf("band-limited noise bursts: %+.3f dBTP over the ceiling\n", bandLimited);
+    CHECK(bandLimited <= 0.15f);
+
+    for (const double frequency : {0.02, 0.25, 0.4, 0.45})
+    {
+        for (const double phase : {0.0, 0.4, 0.8, 1.2})
+        {
+            const float sine{limit(SineSignal(12000, frequency, phase))};
+            CHECK(sine <= 0.15f);
+        }
+    }
+
+    // Full-band noise goes further over, see limiter.h
+    const float fullBand{limit(LoudSignal(24000))};
+    std::printf("full-band noise bursts: %+.3f dBTP over the ceiling\n", fullBand);
+    CHECK(fullBand <= 1.2f);
+}
+
+// Material under the ceiling comes out unchanged, only delayed by GetLatency()
+static void TestQuietSignalPassesThrough()
+{
+    std::vector<float> input(9600);
+
+    for (std::size_t i{0}; i < input.size(); ++i)
+    {
+        input[i] = 0.25f * static_cast<float>(std::sin(2.0 * pi * 440.0 * static_cast<double>(i) / sampleRate));
+    }
+
+    BrickwallLimiter limiter{};
+    limiter.Prepare(sampleRate, LimiterSettings{});
+
+    const std::vector<float> output{ProcessFile("limiter_test_quiet", input, limiter, 256)};
+    const std::size_t latency{limiter.GetLatency()};
+
+    CHECK(latency > 0);
+
+    float maxError{0.0f};
+
+    for (std::size_t i{latency}; i < output.size(); ++i)
+    {
+        maxError = std::max(maxError, std::fabs(output[i] - input[i - latency]));
+    }
+
+    CHECK(maxError < 1e-6f);
+}
+
+// The AVX2 detector matches the scalar one
+static void TestPathsMatch()
+{
+    if (!BrickwallLimiter::IsAvx2Supported())
+    {
+        std::printf("AVX2 not supported, skipping the path comparison\n");
+        return;
+    }
+
+    const std::vector<float> input{LoudSignal(24000)};
+
+    BrickwallLimiter scalar{};
+    scalar.Prepare(sampleRate, LimiterSettings{0.5f, 1.5f, 50.0f});
+    scalar.SetPath(BrickwallLimiter::Path::Scalar);
+
+    BrickwallLimiter avx2{};
+    avx2.Prepare(sampleRate, LimiterSettings{0.5f, 1.5f, 50.0f});
+    avx2.SetPath(BrickwallLimiter::Path::Avx2);
+    CHECK(avx2.GetPath() == BrickwallLimiter::Path::Avx2);
+
+    const std::vector<float> a{ProcessFile("limiter_test_scalar", input, scalar, 480)};
+    const std::vector<float> b{ProcessFile("limiter_test_avx2", input, avx2, 480)};
+
+    float maxError{0.0f};
+
+    for (std::size_t i{0}; i < a.size() && i < b.size(); ++i)
+    {
+        maxError = std::max(maxError, std::fabs(a[i] - b[i]));
+    }
+
+    CHECK(maxError < 1e-4f);
+
+    // The detectors on their own, which is what limiter_bench times
+    scalar.Reset();
+    avx2.Reset();
+
+    std::vector<float> scalarPeaks(input.size());
+    std::vector<float> avx2Peaks(input.size());
+    scalar.DetectPeaks(input.data(), scalarPeaks.data(), input.size());
+    avx2.DetectPeaks(input.data(), avx2Peaks.data(), input.size());
+
+    float maxPeakError{0.0f};
+
+    for (std::size_t i{0}; i < input.size(); ++i)
+    {
+        maxPeakError = std::max(maxPeakError, std::fabs(scalarPeaks[i] - avx2Peaks[i]));
+    }
+
+    CHECK(maxPeakError < 1e-4f);
+}
+
+// The detected peak of an interval is never below the samples around it
+static void TestDetectPeaksCoverSamples()
+{
+    const std::vector<float> input{LoudSignal(24000)};
+
+    BrickwallLimiter limiter{};
+    limiter.Prepare(sampleRate, LimiterSettings{});
+
+    std::vector<float> peaks(input.size());
+    limiter.DetectPeaks(input.data(), peaks.data(), input.size());
+
+    // peaks[n] covers the interval input[n - 16]..input[n - 15]
+    constexpr std::size_t delay{16};
+    std::size_t misses{0};
+
+    for (std::size_t n{delay}; n < input.size(); ++n)
+    {
+        misses += (peaks[n] < std::fabs(input[n - delay]) || peaks[n] < std::fabs(input[n - delay + 1])) ? 1 : 0;
+    }
+
+    CHECK(misses == 0);
+}
+
+// Max volume positions map to amplitudes through the cubic taper
+static void TestCeilingFromMaxVolume()
+{
+    CHECK(LimiterCeilingFromMaxVolume(1.0f) == 1.0f);
+    CHECK(LimiterCeilingFromMaxVolume(1.5f) == 1.0f);
+    CHECK(LimiterCeilingFromMaxVolume(0.0f) == 0.0f);
+    CHECK(LimiterCeilingFromMaxVolume(-0.5f) == 0.0f);
+    CHECK(std::fabs(LimiterCeilingFromMaxVolume(0.5f) - 0.125f) < 1e-6f);
+
+    // 80 in the Max Volume box is about -5.8 dB
+    const float db{20.0f * std::log10(LimiterCeilingFromMaxVolume(0.8f))};
+    CHECK(db > -5.9f && db < -5.7f);
+}
+
+int main()
+{
+    TestOutputStaysUnderCeiling();
+    TestImpulsesStayUnderCeiling();
+    TestOutputTruePeak();
+    TestQuietSignalPassesThrough();
+    TestPathsMatch();
+    TestDetectPeaksCoverSamples();
+    TestCeilingFromMaxVolume();
+
+    return CheckResult();
+}
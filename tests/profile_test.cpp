@@ -0,0 +1,143 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string>
+#include <utility>
+#include "check.h"
+#include "profile.h"
+
+static AudioState MakeState(float level, bool muted, float cap)
+{
+    AudioState state{};
+    state.endpoints = {EndpointState{"speakers", level, muted}, EndpointState{"headphones", level, false}};
+    state.sessions  = {SessionState{"browser", cap}, SessionState{"player", cap}};
+
+    return state;
+}
+
+// Fails every write from the given index on, so the rollback fails as well
+class FailingBackend : public SimulatedAudioBackend
+{
+public:
+    FailingBackend(AudioState initial, std::size_t firstFailure) : SimulatedAudioBackend{std::move(initial)}, failFrom{firstFailure} {}
+
+    bool Write(const AudioWrite& write) override
+    {
+        return (writes++ < failFrom) && SimulatedAudioBackend::Write(write);
+    }
+
+private:
+    std::size_t failFrom;
+    std::size_t writes{0};
+};
+
+// Only the settings that differ are written, in batch order
+static void TestDiffIsMinimal()
+{
+    AudioState current{MakeState(0.5f, false, 1.0f)};
+    AudioState target{MakeState(0.5f, false, 1.0f)};
+    SortAudioState(current);
+    SortAudioState(target);
+
+    CHECK(DiffAudioState(current, target).empty());
+
+    target.isVolumeLocked = true;
+    target.maxVolume = 0.8f;
+    target.endpoints[1].muted = true;
+    target.sessions[0].cap = 0.3f;
+
+    // Closer than half a slider step
+    target.endpoints[0].level = 0.502f;
+
+    const std::vector<AudioWrite> writes{DiffAudioState(current, target)};
+
+    CHECK(writes.size() == 4);
+    CHECK(writes.size() == 4 && writes[0].kind == AudioWriteKind::MaxVolume);
+    CHECK(writes.size() == 4 && writes[1].kind == AudioWriteKind::SessionCap && writes[1].id == "browser");
+    CHECK(writes.size() == 4 && writes[2].kind == AudioWriteKind::EndpointMute && writes[2].id == "speakers");
+    CHECK(writes.size() == 4 && writes[3].kind == AudioWriteKind::VolumeLock);
+}
+
+static void TestApply()
+{
+    SimulatedAudioBackend backend{MakeState(0.5f, false, 1.0f)};
+    const AudioProfile exam{"Exam", MakeState(0.2f, true, 0.5f)};
+
+    const ApplyResult result{ApplyProfile(backend, exam)};
+
+    CHECK(result.succeeded);
+    CHECK(result.writesRolledBack == 0);
+    CHECK(backend.GetState().endpoints[1].level == 0.2f);
+    CHECK(backend.GetState().endpoints[1].muted);
+    CHECK(backend.GetState().sessions[0].cap == 0.5f);
+
+    // Applying it again changes nothing
+    const std::size_t writeCount{backend.GetWriteCount()};
+    CHECK(ApplyProfile(backend, exam).writesIssued == 0);
+    CHECK(backend.GetWriteCount() == writeCount);
+}
+
+// A failed write restores the previous state
+static void TestRollback()
+{
+    const AudioState initial{MakeState(0.5f, false, 1.0f)};
+    SimulatedAudioBackend backend{initial};
+    AudioProfile exam{"Exam", MakeState(0.2f, true, 0.5f)};
+    exam.state.isVolumeLocked = true;
+
+    backend.FailWriteAt(3);
+
+    const ApplyResult result{ApplyProfile(backend, exam)};
+
+    CHECK(!result.succeeded);
+    CHECK(result.writesIssued == 4);
+    CHECK(result.writesRolledBack == 4);
+    CHECK(result.rollbackFailures == 0);
+
+    AudioState expected{initial};
+    SortAudioState(expected);
+
+    CHECK(DiffAudioState(backend.GetState(), expected).empty());
+    CHECK(!backend.GetState().isVolumeLocked);
+}
+
+// Undo writes that fail are reported, and the rest of the rollback still runs
+static void TestRollbackFailure()
+{
+    FailingBackend backend{MakeState(0.5f, false, 1.0f), 3};
+    const AudioProfile exam{"Exam", MakeState(0.2f, true, 0.5f)};
+
+    const ApplyResult result{ApplyProfile(backend, exam)};
+
+    CHECK(!result.succeeded);
+    CHECK(result.writesIssued == 4);
+    CHECK(result.writesRolledBack == 4);
+    CHECK(result.rollbackFailures == 4);
+}
+
+int main()
+{
+    TestDiffIsMinimal();
+    TestApply();
+    TestRollback();
+    TestRollbackFailure();
+
+    return CheckResult();
+}
@@ -0,0 +1,356 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The runtime tests use eventfd for waitable descriptors, so they are Linux only
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "check.h"
+#include "runtime.h"
+
+using namespace std::chrono_literals;
+
+static Task SleepAndRecord(Runtime& runtime, Runtime::Clock::duration delay, int id, std::vector<int>& order)
+{
+    co_await runtime.SleepFor(delay);
+    order.push_back(id);
+}
+
+static Task StopAfter(Runtime& runtime, Runtime::Clock::duration delay, int code)
+{
+    co_await runtime.SleepFor(delay);
+    runtime.Stop(code);
+}
+
+// Timers resume earliest deadline first, and Stop() ends Run() with its code
+static void TestTimerOrder()
+{
+    Runtime runtime{};
+    std::vector<int> order{};
+
+    Task c{SleepAndRecord(runtime, 30ms, 3, order)};
+    Task a{SleepAndRecord(runtime, 10ms, 1, order)};
+    Task b{SleepAndRecord(runtime, 20ms, 2, order)};
+    Task stop{StopAfter(runtime, 40ms, 7)};
+
+    CHECK(runtime.GetPendingTimerCount() == 4);
+    CHECK(runtime.Run() == 7);
+    CHECK((order == std::vector<int>{1, 2, 3}));
+    CHECK(a.IsDone() && b.IsDone() && c.IsDone());
+}
+
+static Task AddEarlierTimer(Runtime& runtime, Notification& notification, Runtime::Clock::duration& firedAfter)
+{
+    co_await notification;
+
+    // Earlier than the 200 ms deadline the timer is currently armed for
+    const Runtime::Clock::time_point start{Runtime::Clock::now()};
+    co_await runtime.SleepFor(5ms);
+
+    firedAfter = Runtime::Clock::now() - start;
+    runtime.Stop();
+}
+
+// A timer added while the reactor is armed for a later deadline still fires on time
+static void TestEarlierTimerRearms()
+{
+    Runtime runtime{};
+    Notification notification{runtime};
+    std::vector<int> order{};
+    Runtime::Clock::duration firedAfter{};
+
+    Task late{SleepAndRecord(runtime, 200ms, 1, order)};
+    Task early{AddEarlierTimer(runtime, notification, firedAfter)};
+
+    // Wakes the reactor through the wake descriptor, not the timer
+    std::thread backend{[&notification]
+    {
+        std::this_thread::sleep_for(5ms);
+        notification.Notify();
+    }};
+
+    runtime.Run();
+    backend.join();
+
+    CHECK(order.empty());
+    CHECK(firedAfter >= 5ms && firedAfter < 150ms);
+}
+
+static Task WaitAndRecord(Runtime& runtime, int fd, int id, std::vector<int>& order)
+{
+    co_await runtime.WaitReady(fd);
+    order.push_back(id);
+}
+
+static Task SignalAfter(Runtime& runtime, Runtime::Clock::duration delay, int fd)
+{
+    co_await runtime.SleepFor(delay);
+
+    const std::uint64_t one{1};
+    CHECK(write(fd, &one, sizeof(one)) == sizeof(one));
+
+    // Let the waiters run before stopping
+    co_await runtime.SleepFor(10ms);
+    runtime.Stop();
+}
+
+// A second waiter on the same descriptor must not replace the first one
+static void TestWaitersShareDescriptor()
+{
+    Runtime runtime{};
+    std::vector<int> order{};
+    const int fd{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+
+    Task first{WaitAndRecord(runtime, fd, 1, order)};
+    Task second{WaitAndRecord(runtime, fd, 2, order)};
+    Task signal{SignalAfter(runtime, 5ms, fd)};
+
+    runtime.Run();
+
+    CHECK((order == std::vector<int>{1, 2}));
+    CHECK(first.IsDone() && second.IsDone());
+
+    close(fd);
+}
+
+// A descriptor can be waited on again after it fired
+static void TestWaiterRearms()
+{
+    Runtime runtime{};
+    std::vector<int> order{};
+    const int fd{eventfd(0, EFD_CLOEXEC)};
+    std::uint64_t value{};
+
+    {
+        Task first{WaitAndRecord(runtime, fd, 1, order)};
+        Task signal{SignalAfter(runtime, 5ms, fd)};
+        runtime.Run();
+    }
+
+    CHECK(read(fd, &value, sizeof(value)) == sizeof(value));
+
+    {
+        Task second{WaitAndRecord(runtime, fd, 2, order)};
+        Task signal{SignalAfter(runtime, 5ms, fd)};
+        runtime.Run();
+    }
+
+    CHECK((order == std::vector<int>{1, 2}));
+
+    close(fd);
+}
+
+static Task WaitNotification(Runtime& runtime, Notification& notification, int& count)
+{
+    for (;;)
+    {
+        co_await notification;
+
+        if (++count == 2)
+        {
+            runtime.Stop();
+        }
+    }
+}
+
+// Notifications raised on another thread wake the runtime, and one raised
+// while nobody waits is remembered
+static void TestNotificationAcrossThreads()
+{
+    Runtime runtime{};
+    Notification notification{runtime};
+    int count{0};
+
+    notification.Notify();
+
+    Task waiter{WaitNotification(runtime, notification, count)};
+    CHECK(count == 1);
+
+    std::thread backend{[&notification]
+    {
+        std::this_thread::sleep_for(10ms);
+        notification.Notify();
+    }};
+
+    runtime.Run();
+    backend.join();
+
+    CHECK(count == 2);
+}
+
+static Task WaitOnce(Notification& notification, int id, std::vector<int>& order)
+{
+    co_await notification;
+    order.push_back(id);
+}
+
+static Task NotifyAfter(Runtime& runtime, Runtime::Clock::duration delay, Notification& notification)
+{
+    co_await runtime.SleepFor(delay);
+    notification.Notify();
+
+    co_await runtime.SleepFor(5ms);
+    runtime.Stop();
+}
+
+// A second coroutine waiting on a notification must not replace the first one
+static void TestNotificationWakesAllWaiters()
+{
+    Runtime runtime{};
+    Notification notification{runtime};
+    std::vector<int> order{};
+
+    Task first{WaitOnce(notification, 1, order)};
+    Task second{WaitOnce(notification, 2, order)};
+    Task notify{NotifyAfter(runtime, 1ms, notification)};
+
+    runtime.Run();
+
+    CHECK((order == std::vector<int>{1, 2}));
+    CHECK(first.IsDone() && second.IsDone());
+}
+
+static Task RescheduleAndRecord(Runtime& runtime, int id, std::vector<int>& order)
+{
+    for (int i{0}; i < 2; ++i)
+    {
+        order.push_back(id);
+        co_await runtime.Reschedule();
+    }
+}
+
+static Task StopNext(Runtime& runtime)
+{
+    co_await runtime.Reschedule();
+    co_await runtime.Reschedule();
+    co_await runtime.Reschedule();
+    runtime.Stop();
+}
+
+// Reschedule lets the other ready coroutines run before resuming
+static void TestRescheduleInterleaves()
+{
+    Runtime runtime{};
+    std::vector<int> order{};
+
+    Task a{RescheduleAndRecord(runtime, 1, order)};
+    Task b{RescheduleAndRecord(runtime, 2, order)};
+    Task stop{StopNext(runtime)};
+
+    runtime.Run();
+
+    CHECK((order == std::vector<int>{1, 2, 1, 2}));
+    CHECK(a.IsDone() && b.IsDone());
+}
+
+static Task Sleeper(Runtime& runtime, Runtime::Clock::duration delay, int& resumes)
+{
+    co_await runtime.SleepFor(delay);
+    ++resumes;
+}
+
+static Task Waiter(Runtime& runtime, int fd, int& resumes)
+{
+    co_await runtime.WaitReady(fd);
+    ++resumes;
+}
+
+static Task Rescheduler(Runtime& runtime, int& resumes)
+{
+    co_await runtime.Reschedule();
+    ++resumes;
+}
+
+static Task NotificationWaiter(Notification& notification, int& resumes)
+{
+    co_await notification;
+    ++resumes;
+}
+
+// A Task destroyed while suspended is taken out of every queue and never resumed
+static void TestDestroyedTaskIsNotResumed()
+{
+    Runtime runtime{};
+    Notification notification{runtime};
+    const int fd{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+    int resumes{0};
+
+    {
+        Task sleeper{Sleeper(runtime, 5ms, resumes)};
+        Task waiter{Waiter(runtime, fd, resumes)};
+        Task rescheduler{Rescheduler(runtime, resumes)};
+        Task notified{NotificationWaiter(notification, resumes)};
+
+        CHECK(runtime.GetPendingTimerCount() == 1);
+    }
+
+    CHECK(runtime.GetPendingTimerCount() == 0);
+
+    // Everything they were waiting for happens, only the survivor runs
+    notification.Notify();
+
+    std::vector<int> order{};
+    Task survivor{SleepAndRecord(runtime, 10ms, 1, order)};
+    Task signal{SignalAfter(runtime, 1ms, fd)};
+
+    runtime.Run();
+
+    CHECK(resumes == 0);
+    CHECK((order == std::vector<int>{1}));
+
+    close(fd);
+}
+
+// Replacing a suspended Task destroys the old coroutine the same way
+static void TestMoveAssignCancels()
+{
+    Runtime runtime{};
+    int resumes{0};
+
+    Task task{Sleeper(runtime, 1ms, resumes)};
+    task = Sleeper(runtime, 2ms, resumes);
+
+    CHECK(runtime.GetPendingTimerCount() == 1);
+
+    Task stop{StopAfter(runtime, 10ms, 0)};
+    runtime.Run();
+
+    CHECK(resumes == 1);
+    CHECK(task.IsDone());
+}
+
+int main()
+{
+    TestTimerOrder();
+    TestEarlierTimerRearms();
+    TestWaitersShareDescriptor();
+    TestWaiterRearms();
+    TestNotificationAcrossThreads();
+    TestNotificationWakesAllWaiters();
+    TestRescheduleInterleaves();
+    TestDestroyedTaskIsNotResumed();
+    TestMoveAssignCancels();
+
+    return CheckResult();
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "check.h"
+#include "slider_input.h"
+
+// A thumb drag holds ownership and coalesces into one write per frame
+static void TestDragCoalesces()
+{
+    SliderInput input{};
+    float volume{};
+
+    input.OnThumbTrack(10);
+    input.OnThumbTrack(20);
+    input.OnThumbTrack(30);
+
+    CHECK(input.GetOwner() == SliderInput::Owner::User);
+    CHECK(!input.FollowsSystem());
+    CHECK(input.TakePendingWrite(volume));
+    CHECK(volume == 0.3f);
+    CHECK(!input.TakePendingWrite(volume));
+    CHECK(input.GetCoalescedCount() == 2);
+
+    // Still dragging, the slider must not follow the system between moves
+    CHECK(!input.FollowsSystem());
+}
+
+// Releasing the thumb writes the final position, then hands back ownership
+static void TestEndTrackReleases()
+{
+    SliderInput input{};
+    float volume{};
+
+    input.OnThumbTrack(40);
+    input.OnEndTrack(45);
+
+    CHECK(input.GetOwner() == SliderInput::Owner::System);
+    CHECK(!input.FollowsSystem());
+    CHECK(input.TakePendingWrite(volume));
+    CHECK(volume == 0.45f);
+    CHECK(input.FollowsSystem());
+}
+
+// Wheel and keyboard steps arrive without TB_ENDTRACK and must not keep ownership
+static void TestStepDoesNotHoldOwnership()
+{
+    SliderInput input{};
+    float volume{};
+
+    input.OnStep(51);
+
+    CHECK(input.GetOwner() == SliderInput::Owner::System);
+    CHECK(!input.FollowsSystem());
+    CHECK(input.TakePendingWrite(volume));
+    CHECK(volume == 0.51f);
+    CHECK(input.FollowsSystem());
+}
+
+// A step during a drag doesn't end the drag
+static void TestStepDuringDrag()
+{
+    SliderInput input{};
+    float volume{};
+
+    input.OnThumbTrack(20);
+    input.OnStep(21);
+
+    CHECK(input.GetOwner() == SliderInput::Owner::User);
+    CHECK(input.TakePendingWrite(volume));
+    CHECK(volume == 0.21f);
+    CHECK(!input.FollowsSystem());
+}
+
+static void TestClamp()
+{
+    SliderInput input{};
+    float volume{};
+
+    input.OnStep(-5);
+    CHECK(input.TakePendingWrite(volume));
+    CHECK(volume == 0.0f);
+
+    input.OnStep(150);
+    CHECK(input.TakePendingWrite(volume));
+    CHECK(volume == 1.0f);
+}
+
+int main()
+{
+    TestDragCoalesces();
+    TestEndTrackReleases();
+    TestStepDoesNotHoldOwnership();
+    TestStepDuringDrag();
+    TestClamp();
+
+    return CheckResult();
+}
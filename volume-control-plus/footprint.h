@@ -0,0 +1,76 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+// Memory footprint accounting for the MinSize build profile.
+//
+// Building with VCP_MINIMAL_FOOTPRINT replaces the global operator new/delete
+// with counting versions, so the app can check that the enforcement loop does
+// not allocate once it has warmed up and that the process stays within budget.
+// In other builds the allocation count is always 0.
+
+// Limits checked by IsWithinFootprintBudget, override them on the command line
+#ifndef VCP_PEAK_RESIDENT_BUDGET
+#define VCP_PEAK_RESIDENT_BUDGET (8u * 1024u * 1024u)
+#endif
+
+#ifndef VCP_ALLOCATION_BUDGET
+#define VCP_ALLOCATION_BUDGET 256u
+#endif
+
+struct FootprintBudget
+{
+    // Peak resident set size (peak working set on Windows) in bytes
+    std::size_t maxPeakResidentBytes;
+
+    // Number of operator new calls since startup
+    std::size_t maxAllocations;
+};
+
+constexpr FootprintBudget defaultFootprintBudget{VCP_PEAK_RESIDENT_BUDGET, VCP_ALLOCATION_BUDGET};
+
+// Number of operator new calls since startup
+std::size_t GetAllocationCount();
+
+// Number of operator new calls made by the calling thread since it started
+std::size_t GetThreadAllocationCount();
+
+// Counts the operator new calls the calling thread makes while the probe is in
+// scope. Only the replaced operator new is seen: COM and GDI allocate from
+// their own heaps, which show up in the peak resident size instead.
+class AllocationProbe
+{
+public:
+    AllocationProbe() : start{GetThreadAllocationCount()} {}
+
+    std::size_t GetAllocations() const { return GetThreadAllocationCount() - start; }
+
+private:
+    std::size_t start;
+};
+
+// Peak resident memory of the process in bytes, 0 if it can't be queried
+std::size_t GetPeakResidentBytes();
+
+// Returns true if both the peak resident memory and the allocation count are within the budget
+bool IsWithinFootprintBudget(const FootprintBudget& budget = defaultFootprintBudget);
@@ -19,13 +19,18 @@
 // SOFTWARE.
 
 #include <chrono>
-#include <thread>
-#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <windows.h>
 #include <commctrl.h>
 #include <mmdeviceapi.h>
 #include <endpointvolume.h>
 #include <functiondiscoverykeys_devpkey.h>
+#include "footprint.h"
+#include "profile.h"
+#include "runtime.h"
+#include "slider_input.h"
 
 // Window size
 constexpr int windowWidth{580};
@@ -58,25 +63,54 @@ HWND hMuteToggleCheckbox{};
 // Mute checkbox
 HWND hMuteCheckbox{};
 
+// Volume slider
+HWND hVolumeSlider{};
+
+// Profile selection
+HWND hProfileComboBox{};
+
 // PIN string
-static std::string strText{};
-static std::string strPIN{};
+static char strText[256]{};
+static char strPIN[256]{};
 
 // Max volume string
-static std::string strMaxVolume{"100"};
+static char strMaxVolume[256]{"100"};
+
+// Volume slider ownership, driven by the trackbar notifications
+static SliderInput sliderInput{};
 
 constexpr float minVolume{0.0f};
 constexpr uint8_t x{30};
 
-// Set master volume
-static HRESULT SetMasterVolume(float volume)
+// White surface for the layered window, created on first use
+static struct { HDC hdcMem; HBITMAP hBitmap; HGDIOBJ hOldBitmap; } layeredSurface{};
+
+// Acquire the default endpoint volume interface. The endpoint is looked up on
+// every call, so the lock and the cap follow a change of default device. In the
+// MinSize profile only COM and the device enumerator are kept between calls.
+static IAudioEndpointVolume* AcquireEndpointVolume()
 {
+    HRESULT hr{};
+
+#ifdef VCP_MINIMAL_FOOTPRINT
+    static IMMDeviceEnumerator* pEnumerator{};
+
+    if (pEnumerator == NULL)
+    {
+        // Initialize COM library
+        hr = CoInitialize(NULL);
+
+        // Create device enumerator
+        hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator);
+    }
+#else
     // Initialize COM library
-    HRESULT hr{CoInitialize(NULL)};
+    hr = CoInitialize(NULL);
 
     // Create device enumerator
     IMMDeviceEnumerator* pEnumerator{};
     hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator);
+#endif
 
     // Get the default audio endpoint
     IMMDevice* pDevice{};
@@ -86,14 +120,37 @@ static HRESULT SetMasterVolume(float volume)
     IAudioEndpointVolume* pEndpointVolume{};
     hr = pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, NULL, (void**)&pEndpointVolume);
 
-    // Set the master volume level
-    hr = pEndpointVolume->SetMasterVolumeLevelScalar(volume, NULL);
-
-    // Release resources
-    pEndpointVolume->Release();
+    // The endpoint volume keeps what it needs alive
     pDevice->Release();
+
+#ifndef VCP_MINIMAL_FOOTPRINT
     pEnumerator->Release();
+#endif
+
+    return pEndpointVolume;
+}
+
+// Release an interface returned by AcquireEndpointVolume
+static void ReleaseEndpointVolume(IAudioEndpointVolume* pEndpointVolume)
+{
+    pEndpointVolume->Release();
+
+#ifndef VCP_MINIMAL_FOOTPRINT
     CoUninitialize();
+#endif
+}
+
+// Set master volume
+static HRESULT SetMasterVolume(float volume)
+{
+    // Get the default audio endpoint volume interface
+    IAudioEndpointVolume* const pEndpointVolume{AcquireEndpointVolume()};
+
+    // Set the master volume level
+    const HRESULT hr{pEndpointVolume->SetMasterVolumeLevelScalar(volume, NULL)};
+
+    // Release resources
+    ReleaseEndpointVolume(pEndpointVolume);
 
     return hr;
 }
@@ -103,97 +160,199 @@ static float GetMasterVolume()
 {
     float volume{0.0f};
 
-    // Initialize COM library
-    HRESULT hr{CoInitialize(NULL)};
-
-    // Create device enumerator
-    IMMDeviceEnumerator* pEnumerator{};
-    hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator);
-
-    // Get the default audio endpoint
-    IMMDevice* pDevice{};
-    hr = pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice);
-
-    // Activate the audio endpoint volume interface
-    IAudioEndpointVolume* pEndpointVolume{};
-    hr = pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, NULL, (void**)&pEndpointVolume);
+    // Get the default audio endpoint volume interface
+    IAudioEndpointVolume* const pEndpointVolume{AcquireEndpointVolume()};
 
     // Get the master volume level
-    hr = pEndpointVolume->GetMasterVolumeLevelScalar(&volume);
+    pEndpointVolume->GetMasterVolumeLevelScalar(&volume);
 
     // Release resources
-    pEndpointVolume->Release();
-    pDevice->Release();
-    pEnumerator->Release();
-    CoUninitialize();
+    ReleaseEndpointVolume(pEndpointVolume);
 
     return volume;
 }
 
-// Check collision between mouse and rectangle
-static bool CheckCollisionMouseRect(POINT mousePos, RECT rect) 
-{
-    return PtInRect(&rect, mousePos);
-}
-
 // Returns true if system audio is muted
 static bool IsMuted()
 {
-    // Initialize COM library
-    HRESULT hr{CoInitialize(NULL)};
-
-    // Create device enumerator
-    IMMDeviceEnumerator* pEnumerator{};
-    hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator);
-
-    // Get the default audio endpoint
-    IMMDevice* pDevice{};
-    hr = pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice);
-
-    // Activate the audio endpoint volume interface
-    IAudioEndpointVolume* pEndpointVolume{};
-    hr = pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, NULL, (void**)&pEndpointVolume);
+    // Get the default audio endpoint volume interface
+    IAudioEndpointVolume* const pEndpointVolume{AcquireEndpointVolume()};
 
     // Get mute state
     BOOL mute{};
-    hr = pEndpointVolume->GetMute(&mute);
+    pEndpointVolume->GetMute(&mute);
 
     // Release resources
-    pEndpointVolume->Release();
-    pDevice->Release();
-    pEnumerator->Release();
-    CoUninitialize();
+    ReleaseEndpointVolume(pEndpointVolume);
 
     // Return mute state as bool
     return mute == TRUE;
 }
 
 // Mutes/unmutes system audio based on the mute parameter
-static void SetMute(bool mute)
+static HRESULT SetMute(bool mute)
 {
-    // Initialize COM library
-    HRESULT hr{CoInitialize(NULL)};
+    // Get the default audio endpoint volume interface
+    IAudioEndpointVolume* const pEndpointVolume{AcquireEndpointVolume()};
 
-    // Create device enumerator
-    IMMDeviceEnumerator* pEnumerator{};
-    hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), NULL, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator);
+    // Set mute state
+    const HRESULT hr{pEndpointVolume->SetMute(mute ? TRUE : FALSE, NULL)};
 
-    // Get the default audio endpoint
-    IMMDevice* pDevice{};
-    hr = pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice);
+    // Release resources
+    ReleaseEndpointVolume(pEndpointVolume);
 
-    // Activate the audio endpoint volume interface
-    IAudioEndpointVolume* pEndpointVolume{};
-    hr = pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, NULL, (void**)&pEndpointVolume);
+    return hr;
+}
 
-    // Set mute state
-    hr = pEndpointVolume->SetMute(mute ? TRUE : FALSE, NULL);
+// Endpoint id of the default render device, the only endpoint the app controls
+static const char* const defaultEndpointId{"default"};
 
-    // Release resources
-    pEndpointVolume->Release();
-    pDevice->Release();
-    pEnumerator->Release();
-    CoUninitialize();
+// Profile backend for the default endpoint and the settings in the main window.
+// The app doesn't control individual sessions, so it reports none.
+class WindowsAudioBackend : public AudioBackend
+{
+public:
+    void Read(AudioState& state) override
+    {
+        // Assign in place, a state read before already has the storage
+        state.endpoints.resize(1);
+        state.endpoints[0].id    = defaultEndpointId;
+        state.endpoints[0].level = GetMasterVolume();
+        state.endpoints[0].muted = IsMuted();
+        state.sessions.clear();
+
+        state.isVolumeLocked = isVolumeLocked;
+        state.muteLock       = muteLock;
+        state.maxVolume      = maxVolume;
+    }
+
+    bool Write(const AudioWrite& write) override
+    {
+        switch (write.kind)
+        {
+        case AudioWriteKind::MaxVolume:
+        {
+            maxVolume = write.value;
+
+            // Show the new max volume, EN_CHANGE updates strMaxVolume
+            char text[8]{};
+            std::snprintf(text, sizeof(text), "%ld", std::lround(write.value * 100.0f));
+            SetWindowTextA(maxVolumeTextBox, text);
+
+            return true;
+        }
+        case AudioWriteKind::EndpointMute:
+        {
+            const bool mute{write.value != 0.0f};
+            const HRESULT hr{SetMute(mute)};
+
+            // Keep the checkbox on the endpoint's actual state if the write failed
+            if (SUCCEEDED(hr))
+            {
+                isMuted = mute;
+                SendMessage(hMuteCheckbox, BM_SETCHECK, isMuted ? BST_CHECKED : BST_UNCHECKED, 0);
+            }
+
+            return SUCCEEDED(hr);
+        }
+        case AudioWriteKind::EndpointLevel:
+        {
+            // Move the slider as well, the volume lock enforces its position
+            SendMessage(hVolumeSlider, TBM_SETPOS, TRUE, static_cast<LPARAM>(std::lround(write.value * 100.0f)));
+
+            return SUCCEEDED(SetMasterVolume(write.value));
+        }
+        case AudioWriteKind::MuteLock:
+        {
+            muteLock = (write.value != 0.0f);
+
+            SendMessage(hMuteToggleCheckbox, BM_SETCHECK, muteLock ? BST_CHECKED : BST_UNCHECKED, 0);
+
+            return true;
+        }
+        case AudioWriteKind::VolumeLock:
+        {
+            isVolumeLocked = (write.value != 0.0f);
+
+            // Like the lock button, lock on the current mute state, a stale one would unmute the system
+            isMuted = IsMuted();
+
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+};
+
+static WindowsAudioBackend audioBackend{};
+
+// Reused by every Apply so that it doesn't allocate after the first one
+static ApplyScratch applyScratch{};
+
+// Built-in profiles, Save overwrites the selected one with the current state
+static AudioProfile profiles[]
+{
+    {"Lecture", {{{defaultEndpointId, 0.3f, false}}, {}, true, true, 0.5f}},
+    {"Exam",    {{{defaultEndpointId, 0.0f, true}},  {}, true, true, 0.0f}},
+    {"Break",   {{{defaultEndpointId, 0.5f, false}}, {}, false, false, 1.0f}},
+};
+
+// Draw the white surface onto the window if it is layered. Only layered windows
+// need the 500x300 bitmap, so it is created the first time one asks for it.
+static void UpdateLayeredSurface(HWND hwnd)
+{
+    if ((GetWindowLongPtr(hwnd, GWL_EXSTYLE) & WS_EX_LAYERED) == 0)
+    {
+        return;
+    }
+
+    if (layeredSurface.hdcMem == NULL)
+    {
+        // Create a white HBITMAP
+        const HDC    hdcScreen{GetDC(NULL)};
+        const HBRUSH hBrush{CreateSolidBrush(RGB(255, 255, 255))};
+
+        layeredSurface.hdcMem     = CreateCompatibleDC(hdcScreen);
+        layeredSurface.hBitmap    = CreateCompatibleBitmap(hdcScreen, 500, 300);
+        layeredSurface.hOldBitmap = SelectObject(layeredSurface.hdcMem, layeredSurface.hBitmap);
+
+        // Define the size of the white bitmap
+        const RECT rect{ 0, 0, 500, 300 };
+        FillRect(layeredSurface.hdcMem, &rect, hBrush);
+
+        DeleteObject(hBrush);
+        ReleaseDC(NULL, hdcScreen);
+    }
+
+    // Define the blend function for alpha blending (opaque white)
+    BLENDFUNCTION blend{};
+
+    blend.BlendOp             = AC_SRC_OVER;
+    blend.SourceConstantAlpha = 255; // 255 (opaque)
+    blend.AlphaFormat         = AC_SRC_ALPHA;
+
+    // Update the layered window with the white bitmap
+    POINT ptZero{};
+    SIZE  size{500, 300};
+    POINT ptLocation{0, 0};
+
+    UpdateLayeredWindow(hwnd, NULL, &ptLocation, &size, layeredSurface.hdcMem, &ptZero, RGB(0, 0, 0), &blend, ULW_ALPHA);
+}
+
+// Release the layered window surface if it was ever created
+static void DestroyLayeredSurface()
+{
+    if (layeredSurface.hdcMem == NULL)
+    {
+        return;
+    }
+
+    SelectObject(layeredSurface.hdcMem, layeredSurface.hOldBitmap);
+    DeleteDC(layeredSurface.hdcMem);
+    DeleteObject(layeredSurface.hBitmap);
+
+    layeredSurface = {};
 }
 
 // Declare the window procedure
@@ -261,6 +420,38 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
         NULL
     )};
 
+    hVolumeSlider = slider;
+
+    // Create save profile button
+    const HWND saveProfilebuttonHwnd{CreateWindow(
+        L"BUTTON",
+        L"Save",
+        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+
+        // Save profile button position and size
+        x + 400, 90, 55, 30,
+
+        hwnd,
+        (HMENU)4,
+        GetModuleHandle(NULL),
+        NULL
+    )};
+
+    // Create apply profile button
+    const HWND applyProfilebuttonHwnd{CreateWindow(
+        L"BUTTON",
+        L"Apply",
+        WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
+
+        // Apply profile button position and size
+        x + 465, 90, 55, 30,
+
+        hwnd,
+        (HMENU)5,
+        GetModuleHandle(NULL),
+        NULL
+    )};
+
     // Create set max volume button
     const HWND setMaxVolumebuttonHwnd{CreateWindow(
         L"BUTTON",
@@ -343,132 +534,119 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
     SendMessage(hwnd, WM_SETICON, ICON_BIG, (LPARAM)hCustomIcon);   // Set the large icon
     SendMessage(hwnd, WM_SETICON, ICON_SMALL, (LPARAM)hCustomIcon); // Set the small icon
 
-    // Create a white HBITMAP
-    const HDC     hdcScreen{GetDC(NULL)};
-    const HDC     hdcMem{CreateCompatibleDC(hdcScreen)};
-    const HBITMAP hBitmap{CreateCompatibleBitmap(hdcScreen, 500, 300)};
-    const HGDIOBJ hOldBitmap{SelectObject(hdcMem, hBitmap)};
-    const HBRUSH  hBrush{CreateSolidBrush(RGB(255, 255, 255))};
-
-    // Define the size of the white bitmap
-    const RECT rect{ 0, 0, 500, 300 };
-    FillRect(hdcMem, &rect, hBrush);
-
-    SelectObject(hdcMem, hOldBitmap);
-    DeleteObject(hBrush);
-    ReleaseDC(NULL, hdcScreen);
-
-    // Define the blend function for alpha blending (opaque white)
-    BLENDFUNCTION blend{};
-
-    blend.BlendOp             = AC_SRC_OVER;
-    blend.SourceConstantAlpha = 255; // 255 (opaque)
-    blend.AlphaFormat         = AC_SRC_ALPHA;
-
-    // Update the layered window with the white bitmap
-    POINT ptZero{};
-    SIZE  size{500, 300};
-    POINT ptLocation{0, 0};
-
     // Show and update the window
     ShowWindow(hwnd, nCmdShow);
     UpdateWindow(hwnd);
 
-    // Message loop
-    MSG msg{};
-
     // Get current mute status
     isMuted = IsMuted();
 
-    while (true)
+    // Single-threaded runtime that pumps the message queue and resumes the enforcement loop
+    Runtime runtime{};
+
+    // Enforce the volume policy every 10 ms
+    const auto enforceVolume{[&]() -> Task
     {
-        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        while (true)
         {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
+#ifdef VCP_MINIMAL_FOOTPRINT
+            // Counts what this pass allocates, not the window procedure or profile applies
+            const AllocationProbe probe{};
+#endif
 
-            if (msg.message == WM_QUIT)
+            if (isVolumeLocked)
             {
-                return 0;
-            }
-        }
+                const float sliderValue{static_cast<float>(SendMessage(slider, TBM_GETPOS, 0, 0))};
+                currentVolume = sliderValue / 100.0f;
 
-        if (isVolumeLocked)
-        {
-            const float sliderValue{static_cast<float>(SendMessage(slider, TBM_GETPOS, 0, 0))};
-            currentVolume = sliderValue / 100.0f;
+                SetMasterVolume(currentVolume);
 
-            SetMasterVolume(currentVolume);
+                if (muteLock)
+                {
+                    SetMute(isMuted);
+                }
 
-            if (muteLock)
-            {
-                SetMute(isMuted);
+                SetWindowText(lockUnlockbuttonHwnd, L"Unlock Volume");
             }
-
-            SetWindowText(lockUnlockbuttonHwnd, L"Unlock Volume");
-        }
-        else if (!isVolumeLocked)
-        {
-            if (currentVolume >= minVolume && currentVolume <= maxVolume)
+            else if (!isVolumeLocked)
             {
-                // Get mouse position
-                POINT mousePos{};
-                GetCursorPos(&mousePos);
-                ScreenToClient(hwnd, &mousePos);
-
-                const RECT sliderRect{x + 40, 50, x + 240, 80};
-
-                if (CheckCollisionMouseRect(mousePos, sliderRect))
+                if (currentVolume >= minVolume && currentVolume <= maxVolume)
                 {
-                    const float sliderValue{static_cast<float>(SendMessage(slider, TBM_GETPOS, 0, 0))};
-                    currentVolume = sliderValue / 100.0f;
-
-                    SetMasterVolume(currentVolume);
+                    // The user moved the slider, push the latest value to the system, never above the cap
+                    if (sliderInput.TakePendingWrite(currentVolume))
+                    {
+                        if (currentVolume > maxVolume)
+                        {
+                            currentVolume = maxVolume;
+                        }
+
+                        SetMasterVolume(currentVolume);
+                    }
+                    else if (sliderInput.FollowsSystem())
+                    {
+                        currentVolume = GetMasterVolume();
+
+                        // Assuming currentVolume is a float value between 0.0 and 1.0 representing the volume level
+                        // Convert it to an integer value between 0 and 100 for the trackbar
+                        const int sliderValue{static_cast<int>(currentVolume * 100)};
+
+                        // Set the position of the slider
+                        SendMessage(slider, TBM_SETPOS, TRUE, sliderValue);
+
+                        // Set the range of the slider (0 to 100)
+                        SendMessage(slider, TBM_SETRANGEMIN, TRUE, 0);
+                        SendMessage(slider, TBM_SETRANGEMAX, TRUE, 100);
+                    }
                 }
-                else
+                else if (currentVolume > maxVolume)
                 {
-                    currentVolume = GetMasterVolume();
+                    currentVolume = maxVolume;
+                    SetMasterVolume(currentVolume);
+                }
 
-                    // Assuming currentVolume is a float value between 0.0 and 1.0 representing the volume level
-                    // Convert it to an integer value between 0 and 100 for the trackbar
-                    const int sliderValue{static_cast<int>(currentVolume * 100)};
+                SetWindowText(lockUnlockbuttonHwnd, L"Lock Volume");
+            }
 
-                    // Set the position of the slider
-                    SendMessage(slider, TBM_SETPOS, TRUE, sliderValue);
+            const bool isClickable{(std::strcmp(strText, strPIN) == 0)};
 
-                    // Set the range of the slider (0 to 100)
-                    SendMessage(slider, TBM_SETRANGEMIN, TRUE, 0);
-                    SendMessage(slider, TBM_SETRANGEMAX, TRUE, 100);
-                }
-            }
-            else if (currentVolume > maxVolume)
+            // Enable or disable controls based on state
+            EnableWindow(slider, !isVolumeLocked);           
+            EnableWindow(lockUnlockbuttonHwnd, isClickable); 
+            EnableWindow(setPINbuttonHwnd, strPIN[0] == '\0');
+            EnableWindow(saveProfilebuttonHwnd, isClickable);
+            EnableWindow(applyProfilebuttonHwnd, isClickable);
+
+            UpdateLayeredSurface(hwnd);
+
+#ifdef VCP_MINIMAL_FOOTPRINT
+            // The enforcement pass must not allocate, COM and GDI heap use isn't counted here
+            if (probe.GetAllocations() != 0)
             {
-                currentVolume = maxVolume;
-                SetMasterVolume(currentVolume);
+                OutputDebugString(L"Volume Control Plus: the enforcement loop allocated\n");
             }
+#endif
 
-            SetWindowText(lockUnlockbuttonHwnd, L"Lock Volume");
+            co_await runtime.SleepFor(std::chrono::milliseconds(10));
         }
+    }};
 
-        const bool isClickable{(strText == strPIN)};
-
-        // Enable or disable controls based on state
-        EnableWindow(slider, !isVolumeLocked);           
-        EnableWindow(lockUnlockbuttonHwnd, isClickable); 
-        EnableWindow(setPINbuttonHwnd, strPIN.empty());
+    const Task enforceTask{enforceVolume()};
 
-        UpdateLayeredWindow(hwnd, NULL, &ptLocation, &size, hdcMem, &ptZero, RGB(0, 0, 0), &blend, ULW_ALPHA);
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
+    // Run until WM_QUIT
+    const int exitCode{runtime.Run()};
 
     // Clean up resources
-    SelectObject(hdcMem, hOldBitmap);
-    DeleteDC(hdcMem);
-    DeleteObject(hBitmap);
+    DestroyLayeredSurface();
     DestroyIcon(hCustomIcon);
 
-    return msg.wParam;
+#ifdef VCP_MINIMAL_FOOTPRINT
+    if (!IsWithinFootprintBudget())
+    {
+        OutputDebugString(L"Volume Control Plus: memory budget exceeded\n");
+    }
+#endif
+
+    return exitCode;
 }
 
 // Window procedure
@@ -548,6 +726,28 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
 
         SendMessage(hMuteToggleCheckbox, BM_SETCHECK, BST_CHECKED, 0);
 
+        // Create the profile combobox
+        hProfileComboBox = CreateWindowEx(
+            0, L"COMBOBOX",
+            L"",
+            WS_TABSTOP | WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST,
+
+            // Position and size, the height includes the drop-down list
+            x + 400, 50, 120, 200,
+
+            hwnd,
+            NULL,
+            (HINSTANCE)GetWindowLongPtr(hwnd, GWLP_HINSTANCE),
+            NULL
+        );
+
+        for (const AudioProfile& profile : profiles)
+        {
+            SendMessageA(hProfileComboBox, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(profile.name.c_str()));
+        }
+
+        SendMessage(hProfileComboBox, CB_SETCURSEL, 0, 0);
+
     } break;
     // WM_COMMAND: This message is sent to a window when the user selects a menu item, 
     // clicks a button, or performs an action that generates a command from a control or menu.
@@ -566,33 +766,61 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
         if (LOWORD(wParam) == 2 && HIWORD(wParam) == BN_CLICKED)
         {
             // Get the max volume; it should be more than 0 and less than or equal to 100
-            const unsigned int max{static_cast<unsigned int>((atoi(strMaxVolume.c_str()) > 100) ? 100 : atoi(strMaxVolume.c_str()))};
+            const unsigned int max{static_cast<unsigned int>((atoi(strMaxVolume) > 100) ? 100 : atoi(strMaxVolume))};
 
             maxVolume = static_cast<float>(max/100.0f);
         }
 
+        // The button to save the current state into the selected profile
+        if (LOWORD(wParam) == 4 && HIWORD(wParam) == BN_CLICKED)
+        {
+            const LRESULT selected{SendMessage(hProfileComboBox, CB_GETCURSEL, 0, 0)};
+
+            if (selected != CB_ERR)
+            {
+                audioBackend.Read(profiles[selected].state);
+            }
+        }
+
+        // The button to apply the selected profile
+        if (LOWORD(wParam) == 5 && HIWORD(wParam) == BN_CLICKED)
+        {
+            const LRESULT selected{SendMessage(hProfileComboBox, CB_GETCURSEL, 0, 0)};
+
+            // Only the settings that differ are written; on failure the previous settings are restored
+            if (selected != CB_ERR)
+            {
+                const ApplyResult result{ApplyProfile(audioBackend, profiles[selected], applyScratch)};
+
+                if (!result.succeeded && result.rollbackFailures == 0)
+                {
+                    MessageBoxW(hwnd, L"Failed to apply the profile, the previous settings were restored", L"Error", MB_ICONERROR);
+                }
+                else if (!result.succeeded)
+                {
+                    MessageBoxW(hwnd, L"Failed to apply the profile, and some of the previous settings could not be restored", L"Error", MB_ICONERROR);
+                }
+            }
+        }
+
         // The button to set the PIN
         if (LOWORD(wParam) == 3 && HIWORD(wParam) == BN_CLICKED)
         {
-            strPIN = strText;
+            std::memcpy(strPIN, strText, sizeof(strPIN));
         }
 
         // PIN textbox
         if (reinterpret_cast<HWND>(lParam) == pinTextBox && HIWORD(wParam) == EN_CHANGE)
         {
-            // Text has changed in the PIN textbox, update the std::string
-            char buffer[256];
-            GetWindowTextA(pinTextBox, buffer, sizeof(buffer));
-            strText = buffer;
+            // Text has changed in the PIN textbox, update the string
+            GetWindowTextA(pinTextBox, strText, sizeof(strText));
         }
 
         // Max volume textbox
         if (reinterpret_cast<HWND>(lParam) == maxVolumeTextBox && HIWORD(wParam) == EN_CHANGE)
         {
-            // Text has changed in the max volume textbox, update the std::string
-            char buffer[256];
-            GetWindowTextA(maxVolumeTextBox, buffer, sizeof(buffer));
-            strMaxVolume = buffer;
+            // Text has changed in the max volume textbox, update the string
+            GetWindowTextA(maxVolumeTextBox, strMaxVolume, sizeof(strMaxVolume));
         }
 
         // Update the mute volume
@@ -614,6 +842,37 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
             SendMessage(hMuteToggleCheckbox, BM_SETCHECK, muteLock ? BST_CHECKED : BST_UNCHECKED, 0);   
         }
 
+    } break;
+    // WM_HSCROLL: This message is sent to a window when a horizontal trackbar owned by it changes position, 
+    // whether the user drags the thumb, clicks the channel, scrolls the mouse wheel or uses the keyboard.
+    case WM_HSCROLL:
+    {
+        const HWND trackbar{reinterpret_cast<HWND>(lParam)};
+
+        // The volume slider is the only trackbar
+        if (trackbar == NULL || isVolumeLocked)
+        {
+            break;
+        }
+
+        // TB_THUMBTRACK carries the position, for the other codes ask the trackbar
+        const int position{(LOWORD(wParam) == TB_THUMBTRACK) 
+            ? static_cast<int>(static_cast<short>(HIWORD(wParam))) 
+            : static_cast<int>(SendMessage(trackbar, TBM_GETPOS, 0, 0))};
+
+        if (LOWORD(wParam) == TB_THUMBTRACK)
+        {
+            sliderInput.OnThumbTrack(position);
+        }
+        else if (LOWORD(wParam) == TB_ENDTRACK)
+        {
+            sliderInput.OnEndTrack(position);
+        }
+        else
+        {
+            sliderInput.OnStep(position);
+        }
+
     } break;
     // WM_GETMINMAXINFO: This message is sent to a window when its size or position is about to change. 
     // It provides the window procedure with information about the window's minimum and maximum size constraints.
@@ -646,11 +905,13 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
         const TCHAR* text0{L"Set Volume Level:"};
         const TCHAR* text1{L"Set Max Volume:"};
         const TCHAR* text2{L"Set PIN:"};
+        const TCHAR* text3{L"Profile:"};
 
         // Output the text at specified positions in the window
         TextOut(hdc, x + 10, 14, text0, lstrlen(text0));  
         TextOut(hdc, x + 10, 124, text1, lstrlen(text1));  
         TextOut(hdc, x + 10, 224, text2, lstrlen(text2));
+        TextOut(hdc, x + 400, 14, text3, lstrlen(text3));
 
         EndPaint(hwnd, &ps);
 
@@ -0,0 +1,246 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Levels closer than half a slider step are considered equal
+constexpr float levelTolerance{0.005f};
+
+static bool LevelsDiffer(float a, float b)
+{
+    return std::fabs(a - b) > levelTolerance;
+}
+
+// Call match(current, target) for every id present in both sorted ranges
+template <typename T, typename Match>
+static void ForEachMatch(const std::vector<T>& current, const std::vector<T>& target, Match match)
+{
+    auto c{current.begin()};
+    auto t{target.begin()};
+
+    while (c != current.end() && t != target.end())
+    {
+        if (c->id < t->id)
+        {
+            ++c;
+        }
+        else if (t->id < c->id)
+        {
+            ++t;
+        }
+        else
+        {
+            match(*c, *t);
+            ++c;
+            ++t;
+        }
+    }
+}
+
+// Replace writes with the writes from current to target in batch order, and
+// optionally undo with the writes that restore current
+static void Diff(const AudioState& current, const AudioState& target, std::vector<AudioWrite>& writes, std::vector<AudioWrite>* undo)
+{
+    writes.clear();
+
+    if (undo != nullptr)
+    {
+        undo->clear();
+    }
+
+    const auto add{[&](AudioWriteKind kind, std::string_view id, float from, float to)
+    {
+        writes.push_back(AudioWrite{kind, id, to});
+
+        if (undo != nullptr)
+        {
+            undo->push_back(AudioWrite{kind, id, from});
+        }
+    }};
+
+    if (LevelsDiffer(current.maxVolume, target.maxVolume))
+    {
+        add(AudioWriteKind::MaxVolume, {}, current.maxVolume, target.maxVolume);
+    }
+
+    ForEachMatch(current.sessions, target.sessions, [&](const SessionState& c, const SessionState& t)
+    {
+        if (LevelsDiffer(c.cap, t.cap))
+        {
+            add(AudioWriteKind::SessionCap, t.id, c.cap, t.cap);
+        }
+    });
+
+    ForEachMatch(current.endpoints, target.endpoints, [&](const EndpointState& c, const EndpointState& t)
+    {
+        if (c.muted != t.muted)
+        {
+            add(AudioWriteKind::EndpointMute, t.id, c.muted ? 1.0f : 0.0f, t.muted ? 1.0f : 0.0f);
+        }
+    });
+
+    ForEachMatch(current.endpoints, target.endpoints, [&](const EndpointState& c, const EndpointState& t)
+    {
+        if (LevelsDiffer(c.level, t.level))
+        {
+            add(AudioWriteKind::EndpointLevel, t.id, c.level, t.level);
+        }
+    });
+
+    if (current.muteLock != target.muteLock)
+    {
+        add(AudioWriteKind::MuteLock, {}, current.muteLock ? 1.0f : 0.0f, target.muteLock ? 1.0f : 0.0f);
+    }
+
+    if (current.isVolumeLocked != target.isVolumeLocked)
+    {
+        add(AudioWriteKind::VolumeLock, {}, current.isVolumeLocked ? 1.0f : 0.0f, target.isVolumeLocked ? 1.0f : 0.0f);
+    }
+}
+
+void SortAudioState(AudioState& state)
+{
+    const auto byId{[](const auto& a, const auto& b) { return a.id < b.id; }};
+
+    std::sort(state.endpoints.begin(), state.endpoints.end(), byId);
+    std::sort(state.sessions.begin(), state.sessions.end(), byId);
+}
+
+std::vector<AudioWrite> DiffAudioState(const AudioState& current, const AudioState& target)
+{
+    std::vector<AudioWrite> writes{};
+    Diff(current, target, writes, nullptr);
+
+    return writes;
+}
+
+ApplyResult ApplyProfile(AudioBackend& backend, const AudioProfile& profile, ApplyScratch& scratch)
+{
+    ApplyResult result{};
+
+    backend.Read(scratch.current);
+    SortAudioState(scratch.current);
+
+    // Copy assignment reuses the scratch storage, the ids are sorted in place
+    scratch.target = profile.state;
+    SortAudioState(scratch.target);
+
+    std::vector<AudioWrite>& writes{scratch.writes};
+    std::vector<AudioWrite>& undo{scratch.undo};
+    Diff(scratch.current, scratch.target, writes, &undo);
+
+    for (std::size_t i{0}; i < writes.size(); ++i)
+    {
+        ++result.writesIssued;
+
+        if (backend.Write(writes[i]))
+        {
+            continue;
+        }
+
+        // Restore everything written so far, newest first. The failed write
+        // is restored too in case it was partly applied.
+        result.succeeded = false;
+
+        for (std::size_t j{i + 1}; j > 0; --j)
+        {
+            ++result.writesRolledBack;
+
+            if (!backend.Write(undo[j - 1]))
+            {
+                ++result.rollbackFailures;
+            }
+        }
+
+        break;
+    }
+
+    return result;
+}
+
+ApplyResult ApplyProfile(AudioBackend& backend, const AudioProfile& profile)
+{
+    ApplyScratch scratch{};
+
+    return ApplyProfile(backend, profile, scratch);
+}
+
+SimulatedAudioBackend::SimulatedAudioBackend(AudioState initial) : state{std::move(initial)}
+{
+    SortAudioState(state);
+}
+
+bool SimulatedAudioBackend::Write(const AudioWrite& write)
+{
+    if (failAt >= 0 && writeCount == static_cast<std::size_t>(failAt))
+    {
+        ++writeCount;
+        return false;
+    }
+
+    ++writeCount;
+
+    const auto find{[&](auto& items)
+    {
+        const auto it{std::lower_bound(items.begin(), items.end(), write.id, [](const auto& item, std::string_view id) { return item.id < id; })};
+
+        return (it != items.end() && it->id == write.id) ? &*it : nullptr;
+    }};
+
+    switch (write.kind)
+    {
+    case AudioWriteKind::MaxVolume:
+        state.maxVolume = write.value;
+        return true;
+    case AudioWriteKind::SessionCap:
+        if (SessionState* const session{find(state.sessions)})
+        {
+            session->cap = write.value;
+            return true;
+        }
+        return false;
+    case AudioWriteKind::EndpointMute:
+        if (EndpointState* const endpoint{find(state.endpoints)})
+        {
+            endpoint->muted = write.value != 0.0f;
+            return true;
+        }
+        return false;
+    case AudioWriteKind::EndpointLevel:
+        if (EndpointState* const endpoint{find(state.endpoints)})
+        {
+            endpoint->level = write.value;
+            return true;
+        }
+        return false;
+    case AudioWriteKind::MuteLock:
+        state.muteLock = write.value != 0.0f;
+        return true;
+    case AudioWriteKind::VolumeLock:
+        state.isVolumeLocked = write.value != 0.0f;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Audio state profiles ("lecture", "exam", "break", ...). A profile captures
+// the complete audio state; applying it diffs against the observed state and
+// issues only the writes that change something, as one ordered batch that is
+// rolled back if any write fails.
+
+// Level and mute of one output endpoint
+struct EndpointState
+{
+    std::string id{};
+    float level{1.0f};
+    bool muted{false};
+};
+
+// Volume cap of one audio session
+struct SessionState
+{
+    std::string id{};
+    float cap{1.0f};
+};
+
+struct AudioState
+{
+    // Sorted by id, see SortAudioState
+    std::vector<EndpointState> endpoints{};
+    std::vector<SessionState> sessions{};
+
+    // Lock flags and the global cap, as set in the main window
+    bool isVolumeLocked{false};
+    bool muteLock{true};
+    float maxVolume{1.0f};
+};
+
+struct AudioProfile
+{
+    std::string name{};
+    AudioState state{};
+};
+
+// One backend write. Kinds are listed in the order a batch applies them:
+// caps first, then endpoints, then the lock flags, so the locks engage on the
+// new values.
+enum class AudioWriteKind
+{
+    MaxVolume,
+    SessionCap,
+    EndpointMute,
+    EndpointLevel,
+    MuteLock,
+    VolumeLock
+};
+
+struct AudioWrite
+{
+    AudioWriteKind kind{};
+
+    // Endpoint or session id, empty for the global settings. Points into the
+    // target state the write was diffed from, so no write owns a string.
+    std::string_view id{};
+
+    // Level or cap for the float kinds, 0 or 1 for the flag kinds
+    float value{0.0f};
+};
+
+// Where profiles read the observed state from and send writes to
+class AudioBackend
+{
+public:
+    virtual ~AudioBackend() = default;
+
+    // Overwrite state with the observed state. Assigning into the existing
+    // members keeps their storage, so a repeated read doesn't allocate.
+    virtual void Read(AudioState& state) = 0;
+
+    // Returns false if the write failed
+    virtual bool Write(const AudioWrite& write) = 0;
+};
+
+struct ApplyResult
+{
+    bool succeeded{true};
+
+    // Writes issued for the profile, including a failed one
+    std::size_t writesIssued{0};
+
+    // Writes issued to undo the batch after a failure
+    std::size_t writesRolledBack{0};
+
+    // Undo writes that failed, the previous state wasn't fully restored if non-zero
+    std::size_t rollbackFailures{0};
+};
+
+// Storage ApplyProfile reuses between calls. Once it has grown to the size of
+// the states involved, applying a profile doesn't allocate.
+struct ApplyScratch
+{
+    AudioState current{};
+    AudioState target{};
+    std::vector<AudioWrite> writes{};
+    std::vector<AudioWrite> undo{};
+};
+
+// Sort endpoints and sessions by id so states can be diffed in one pass
+void SortAudioState(AudioState& state);
+
+// Writes that turn current into target, in batch order. Both states must be sorted.
+// Endpoints and sessions that only exist in one of the two are left alone.
+std::vector<AudioWrite> DiffAudioState(const AudioState& current, const AudioState& target);
+
+// Read the observed state, write the difference to target and roll back on failure.
+// A failed undo write doesn't stop the rollback, it is counted in rollbackFailures.
+ApplyResult ApplyProfile(AudioBackend& backend, const AudioProfile& profile, ApplyScratch& scratch);
+
+// Same, with scratch storage that only lives for the call
+ApplyResult ApplyProfile(AudioBackend& backend, const AudioProfile& profile);
+
+// In-memory backend, used to preview what a profile would change and to
+// exercise the apply logic without audio hardware
+class SimulatedAudioBackend : public AudioBackend
+{
+public:
+    explicit SimulatedAudioBackend(AudioState initial = {});
+
+    void Read(AudioState& out) override { out = state; }
+    bool Write(const AudioWrite& write) override;
+
+    const AudioState& GetState() const { return state; }
+    std::size_t GetWriteCount() const { return writeCount; }
+
+    // Make the write with this zero-based index fail, -1 to never fail
+    void FailWriteAt(long index) { failAt = index; }
+
+private:
+    AudioState state{};
+    std::size_t writeCount{0};
+    long failAt{-1};
+};
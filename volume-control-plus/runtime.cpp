@@ -0,0 +1,514 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "runtime.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <ctime>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+Task& Task::operator=(Task&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+
+        handle = other.handle;
+        other.handle = {};
+    }
+
+    return *this;
+}
+
+Task::~Task()
+{
+    Destroy();
+}
+
+void Task::Destroy()
+{
+    if (!handle)
+    {
+        return;
+    }
+
+    // A suspended frame must not stay queued, or the runtime would resume freed memory
+    promise_type& promise{handle.promise()};
+
+    if (promise.notification != nullptr)
+    {
+        promise.notification->Cancel(handle);
+    }
+
+    if (promise.runtime != nullptr)
+    {
+        promise.runtime->Cancel(handle);
+    }
+
+    handle.destroy();
+    handle = {};
+}
+
+void Notification::Notify()
+{
+    const std::lock_guard<std::mutex> lock{mutex};
+
+    if (waiters.empty())
+    {
+        signaled = true;
+        return;
+    }
+
+    // Posted under the lock, so Cancel either removes a waiter first or finds it posted
+    for (const Task::Handle h : waiters)
+    {
+        runtime.Post(h);
+    }
+
+    waiters.clear();
+}
+
+void Notification::Cancel(Task::Handle h)
+{
+    const std::lock_guard<std::mutex> lock{mutex};
+
+    waiters.erase(std::remove(waiters.begin(), waiters.end(), h), waiters.end());
+}
+
+bool Notification::await_ready()
+{
+    const std::lock_guard<std::mutex> lock{mutex};
+
+    // Consume a notification that arrived while nobody was waiting
+    const bool wasSignaled{signaled};
+    signaled = false;
+
+    return wasSignaled;
+}
+
+bool Notification::await_suspend(Task::Handle h)
+{
+    const std::lock_guard<std::mutex> lock{mutex};
+
+    // Notified between await_ready and now, don't suspend
+    if (signaled)
+    {
+        signaled = false;
+        return false;
+    }
+
+    waiters.push_back(h);
+    h.promise().notification = this;
+    h.promise().runtime = &runtime;
+
+    return true;
+}
+
+void Runtime::ReserveCapacity()
+{
+    constexpr std::size_t capacity{64};
+
+    timers.reserve(capacity);
+    deferred.reserve(capacity);
+    posted.reserve(capacity);
+    ready.reserve(capacity);
+    waiters.reserve(capacity);
+}
+
+void Runtime::AddTimer(Clock::time_point deadline, Task::Handle h)
+{
+    h.promise().runtime = this;
+
+    timers.push_back(Timer{deadline, timerSequence++, h});
+    std::push_heap(timers.begin(), timers.end(), std::greater<Timer>{});
+}
+
+void Runtime::DropCancelledTimers()
+{
+    while (!timers.empty() && !timers.front().handle)
+    {
+        std::pop_heap(timers.begin(), timers.end(), std::greater<Timer>{});
+        timers.pop_back();
+    }
+}
+
+std::size_t Runtime::GetPendingTimerCount() const
+{
+    return static_cast<std::size_t>(std::count_if(timers.begin(), timers.end(), [](const Timer& timer) { return static_cast<bool>(timer.handle); }));
+}
+
+void Runtime::Post(Task::Handle h)
+{
+    {
+        const std::lock_guard<std::mutex> lock{postMutex};
+        posted.push_back(h);
+    }
+
+    Wake();
+}
+
+void Runtime::Defer(Task::Handle h)
+{
+    h.promise().runtime = this;
+
+    // Runtime thread only, so no lock and no wake
+    deferred.push_back(h);
+}
+
+bool Runtime::HasReadyWork()
+{
+    if (!deferred.empty() || (!timers.empty() && timers.front().deadline <= Clock::now()))
+    {
+        return true;
+    }
+
+    const std::lock_guard<std::mutex> lock{postMutex};
+
+    return !posted.empty();
+}
+
+void Runtime::Cancel(Task::Handle h)
+{
+    // The heap order only depends on the deadline, so the entry is cleared in place
+    for (Timer& timer : timers)
+    {
+        if (timer.handle == h)
+        {
+            timer.handle = {};
+        }
+    }
+
+    DropCancelledTimers();
+
+    deferred.erase(std::remove(deferred.begin(), deferred.end(), h), deferred.end());
+    waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [h](const Waiter& waiter) { return waiter.coroutine == h; }), waiters.end());
+
+    {
+        const std::lock_guard<std::mutex> lock{postMutex};
+        posted.erase(std::remove(posted.begin(), posted.end(), h), posted.end());
+    }
+
+    // ready may be being iterated, clear the entry instead of erasing it
+    std::replace(ready.begin(), ready.end(), h, Task::Handle{});
+}
+
+void Runtime::ResumeWaiters(NativeHandle handle)
+{
+    std::size_t kept{0};
+
+    for (const Waiter& waiter : waiters)
+    {
+        if (waiter.handle == handle)
+        {
+            ready.push_back(waiter.coroutine);
+        }
+        else
+        {
+            waiters[kept++] = waiter;
+        }
+    }
+
+    waiters.resize(kept);
+}
+
+void Runtime::Stop(int code)
+{
+    isStopped = true;
+    exitCode  = code;
+}
+
+int Runtime::Run()
+{
+    isStopped = false;
+
+    while (RunReady())
+    {
+        // Keep resuming while work is ready and only go through the reactor
+        // when there is none, or every few passes so descriptors (and the
+        // message queue on Windows) aren't starved by busy coroutines
+        for (int pass{1}; pass < maxPassesPerPoll && HasReadyWork(); ++pass)
+        {
+            if (!RunReady())
+            {
+                return exitCode;
+            }
+        }
+
+        Wait();
+    }
+
+    return exitCode;
+}
+
+bool Runtime::RunReady()
+{
+    // Collect rescheduled and posted coroutines
+    ready.insert(ready.end(), deferred.begin(), deferred.end());
+    deferred.clear();
+
+    {
+        const std::lock_guard<std::mutex> lock{postMutex};
+        ready.insert(ready.end(), posted.begin(), posted.end());
+        posted.clear();
+    }
+
+    // Collect expired timers
+    const Clock::time_point now{Clock::now()};
+
+    while (!timers.empty() && timers.front().deadline <= now)
+    {
+        std::pop_heap(timers.begin(), timers.end(), std::greater<Timer>{});
+
+        if (timers.back().handle)
+        {
+            ready.push_back(timers.back().handle);
+        }
+
+        timers.pop_back();
+    }
+
+    DropCancelledTimers();
+
+    // Resumed coroutines only add timers, waiters or posts, never to ready directly
+    std::size_t resumed{0};
+
+    for (; resumed < ready.size() && !isStopped; ++resumed)
+    {
+        const Task::Handle h{ready[resumed]};
+
+        // Cancelled by a coroutine resumed earlier in this pass
+        if (!h)
+        {
+            continue;
+        }
+
+        h.promise().runtime = nullptr;
+        h.promise().notification = nullptr;
+        h.resume();
+    }
+
+    // Coroutines left over when stopped are resumed by the next Run()
+    ready.erase(ready.begin(), ready.begin() + static_cast<std::ptrdiff_t>(resumed));
+
+    return !isStopped;
+}
+
+#ifdef _WIN32
+
+Runtime::Runtime()
+{
+    ReserveCapacity();
+
+    wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+Runtime::~Runtime()
+{
+    CloseHandle(wakeEvent);
+}
+
+void Runtime::AddWaiter(NativeHandle handle, Task::Handle h)
+{
+    h.promise().runtime = this;
+
+    waiters.push_back(Waiter{handle, h});
+}
+
+void Runtime::Wake()
+{
+    SetEvent(wakeEvent);
+}
+
+void Runtime::Wait()
+{
+    // Don't block if something became ready while resuming
+    DWORD timeout{HasReadyWork() ? 0 : INFINITE};
+
+    if (timeout != 0 && !timers.empty())
+    {
+        const auto remaining{timers.front().deadline - Clock::now()};
+
+        // Round up so the timer has expired when we wake up
+        const auto ms{std::chrono::ceil<std::chrono::milliseconds>(remaining).count()};
+        timeout = (ms > 0) ? static_cast<DWORD>(ms) : 0;
+    }
+
+    // The message queue takes one slot of MAXIMUM_WAIT_OBJECTS and the wake event another,
+    // handles beyond that stay pending until earlier ones complete
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS - 1]{};
+    DWORD count{0};
+
+    handles[count++] = wakeEvent;
+
+    for (const Waiter& waiter : waiters)
+    {
+        if (count == MAXIMUM_WAIT_OBJECTS - 1)
+        {
+            break;
+        }
+
+        // The wait functions reject duplicate handles, so list each one once
+        if (std::find(handles, handles + count, waiter.handle) == handles + count)
+        {
+            handles[count++] = waiter.handle;
+        }
+    }
+
+    const DWORD result{MsgWaitForMultipleObjectsEx(count, handles, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE)};
+
+    if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + count)
+    {
+        ResumeWaiters(handles[result - WAIT_OBJECT_0]);
+    }
+    else if (result == WAIT_OBJECT_0 + count)
+    {
+        // Pump the message queue
+        MSG msg{};
+
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            if (msg.message == WM_QUIT)
+            {
+                Stop(static_cast<int>(msg.wParam));
+                return;
+            }
+
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+}
+
+#else
+
+Runtime::Runtime()
+{
+    ReserveCapacity();
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    event.data.fd = timerFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+}
+
+Runtime::~Runtime()
+{
+    close(timerFd);
+    close(wakeFd);
+    close(epollFd);
+}
+
+void Runtime::AddWaiter(NativeHandle handle, Task::Handle h)
+{
+    h.promise().runtime = this;
+
+    const bool isArmed{std::any_of(waiters.begin(), waiters.end(), [handle](const Waiter& waiter) { return waiter.handle == handle; })};
+
+    waiters.push_back(Waiter{handle, h});
+
+    // The descriptor is already armed for an earlier waiter
+    if (isArmed)
+    {
+        return;
+    }
+
+    epoll_event event{};
+    event.events  = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = handle;
+
+    // One-shot descriptors stay registered after firing, so re-arm those
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, handle, &event) != 0 && errno == EEXIST)
+    {
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, handle, &event);
+    }
+}
+
+void Runtime::Wake()
+{
+    const std::uint64_t one{1};
+    [[maybe_unused]] const ssize_t written{write(wakeFd, &one, sizeof(one))};
+}
+
+void Runtime::Wait()
+{
+    // Don't block if something became ready while resuming
+    const int timeout{HasReadyWork() ? 0 : -1};
+
+    // Arm the timerfd for the earliest deadline. It has nanosecond resolution,
+    // unlike the millisecond epoll_wait timeout. It is only re-armed when the
+    // earliest deadline changes.
+    const Clock::time_point deadline{timers.empty() ? Clock::time_point{} : timers.front().deadline};
+
+    if (deadline != armedDeadline)
+    {
+        const auto ns{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count()};
+
+        itimerspec spec{};
+        spec.it_value.tv_sec  = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+
+        // A zero it_value disarms the timer
+        timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, NULL);
+        armedDeadline = deadline;
+    }
+
+    epoll_event events[64];
+    const int count{epoll_wait(epollFd, events, 64, timeout)};
+
+    for (int i{0}; i < count; ++i)
+    {
+        const int fd{events[i].data.fd};
+
+        if (fd == wakeFd)
+        {
+            std::uint64_t value{};
+            [[maybe_unused]] const ssize_t bytes{read(wakeFd, &value, sizeof(value))};
+        }
+        else if (fd == timerFd)
+        {
+            std::uint64_t expirations{};
+            [[maybe_unused]] const ssize_t bytes{read(timerFd, &expirations, sizeof(expirations))};
+
+            // The timerfd disarms itself once it expires
+            armedDeadline = {};
+        }
+        else
+        {
+            ResumeWaiters(fd);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,266 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Single-threaded coroutine runtime. Everything the app waits on (timers,
+// kernel handles, backend notifications and, on Windows, the message queue)
+// is multiplexed by one reactor on the thread that calls Run(), so enforcement
+// logic can be written as straight-line coroutines instead of polling loops.
+//
+// The reactor is epoll on Linux and MsgWaitForMultipleObjectsEx on Windows.
+
+#ifdef _WIN32
+using NativeHandle = HANDLE;
+#else
+using NativeHandle = int;
+#endif
+
+class Runtime;
+class Notification;
+
+// Coroutine return type. The coroutine starts running immediately and its
+// frame is destroyed together with the Task. Destroying a Task that is
+// suspended takes it out of the runtime, it is never resumed.
+class [[nodiscard]] Task
+{
+public:
+    struct promise_type
+    {
+        Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        // Where the suspended coroutine is queued, cleared when it is resumed
+        Runtime* runtime{};
+        Notification* notification{};
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    Task(Task&& other) noexcept : handle{other.handle} { other.handle = {}; }
+    Task& operator=(Task&& other) noexcept;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task();
+
+    bool IsDone() const { return !handle || handle.done(); }
+
+private:
+    explicit Task(Handle h) : handle{h} {}
+
+    // Take the coroutine out of the runtime and destroy its frame
+    void Destroy();
+
+    Handle handle{};
+};
+
+// A signal raised by a backend (possibly from another thread) that coroutines
+// on the runtime thread can wait for. Notify() resumes every coroutine waiting
+// at the time. Signals raised while nobody is waiting are remembered, so a
+// notification is never lost.
+class Notification
+{
+public:
+    explicit Notification(Runtime& owner) : runtime{owner} {}
+
+    // Thread-safe, wakes the reactor if the runtime is blocked
+    void Notify();
+
+    bool await_ready();
+    bool await_suspend(Task::Handle h);
+    void await_resume() {}
+
+private:
+    friend class Task;
+
+    // Forget h if it is waiting, called when its Task is destroyed
+    void Cancel(Task::Handle h);
+
+    Runtime& runtime;
+
+    std::mutex mutex{};
+    bool signaled{false};
+
+    // In the order they started waiting
+    std::vector<Task::Handle> waiters{};
+};
+
+class Runtime
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Runtime();
+    ~Runtime();
+
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+    // Awaitable that resumes the coroutine once the deadline has passed
+    struct TimerAwaiter
+    {
+        Runtime& runtime;
+        Clock::time_point deadline;
+
+        bool await_ready() const { return deadline <= Clock::now(); }
+        void await_suspend(Task::Handle h) { runtime.AddTimer(deadline, h); }
+        void await_resume() const {}
+    };
+
+    // Awaitable that lets everything else that is ready run first
+    struct RescheduleAwaiter
+    {
+        Runtime& runtime;
+
+        bool await_ready() const { return false; }
+        void await_suspend(Task::Handle h) { runtime.Defer(h); }
+        void await_resume() const {}
+    };
+
+    // Awaitable that resumes the coroutine once the handle (Windows) or
+    // file descriptor (Linux) is signaled/readable. Several coroutines may
+    // wait on the same handle, they are all resumed when it becomes ready.
+    struct ReadyAwaiter
+    {
+        Runtime& runtime;
+        NativeHandle handle;
+
+        bool await_ready() const { return false; }
+        void await_suspend(Task::Handle h) { runtime.AddWaiter(handle, h); }
+        void await_resume() const {}
+    };
+
+    TimerAwaiter SleepUntil(Clock::time_point deadline) { return {*this, deadline}; }
+    TimerAwaiter SleepFor(Clock::duration duration) { return {*this, Clock::now() + duration}; }
+    ReadyAwaiter WaitReady(NativeHandle handle) { return {*this, handle}; }
+    RescheduleAwaiter Reschedule() { return {*this}; }
+
+    // Resume the coroutine on the runtime thread. Safe to call from any thread.
+    void Post(Task::Handle h);
+
+    // Run until Stop() is called (or WM_QUIT is received on Windows).
+    // Returns the exit code, which is the WM_QUIT wParam on Windows.
+    int Run();
+
+    void Stop(int code = 0);
+
+    // Timers that haven't expired, not counting those of destroyed Tasks
+    std::size_t GetPendingTimerCount() const;
+
+private:
+    friend class Task;
+
+    struct Timer
+    {
+        Clock::time_point deadline;
+        std::uint64_t sequence;
+
+        // Null once the Task is destroyed, the entry is dropped when it reaches the top
+        Task::Handle handle;
+
+        // Earliest deadline first, ties resume in the order they were added
+        bool operator>(const Timer& other) const
+        {
+            return (deadline != other.deadline) ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    // Reserve the queues up front so steady-state scheduling never allocates
+    void ReserveCapacity();
+
+    void AddTimer(Clock::time_point deadline, Task::Handle h);
+    void AddWaiter(NativeHandle handle, Task::Handle h);
+
+    // Resume on the next pass, runtime thread only (no wake needed)
+    void Defer(Task::Handle h);
+
+    // Remove h from every queue, called when its Task is destroyed
+    void Cancel(Task::Handle h);
+
+    // Remove timers of destroyed Tasks from the top of the heap
+    void DropCancelledTimers();
+
+    // Move every coroutine waiting on handle to ready
+    void ResumeWaiters(NativeHandle handle);
+
+    // Resume everything that became ready, returns false once stopped
+    bool RunReady();
+
+    // Returns true if a coroutine is rescheduled or posted or a timer has expired
+    bool HasReadyWork();
+
+    // Passes RunReady() makes back to back before the reactor is polled
+    static constexpr int maxPassesPerPoll{64};
+
+    // Block until a timer expires, a handle is ready or a post/message arrives
+    void Wait();
+
+    // Wake the reactor from another thread
+    void Wake();
+
+    // Min-heap on the deadline, kept with std::push_heap and std::pop_heap so
+    // entries can be cancelled in place
+    std::vector<Timer> timers{};
+    std::uint64_t timerSequence{0};
+
+    // Coroutines rescheduled on the runtime thread, no lock needed
+    std::vector<Task::Handle> deferred{};
+
+    // Coroutines posted from any thread, guarded by postMutex
+    std::mutex postMutex{};
+    std::vector<Task::Handle> posted{};
+
+    // Coroutines resumed by the current pass, null entries were cancelled
+    std::vector<Task::Handle> ready{};
+
+    bool isStopped{false};
+    int exitCode{0};
+
+    // Coroutines waiting on a handle or descriptor, in the order they started waiting
+    struct Waiter { NativeHandle handle; Task::Handle coroutine; };
+
+    std::vector<Waiter> waiters{};
+
+#ifdef _WIN32
+    HANDLE wakeEvent{};
+#else
+    int epollFd{-1};
+    int wakeFd{-1};
+    int timerFd{-1};
+
+    // Deadline the timerfd is armed for, zero while it is disarmed
+    Clock::time_point armedDeadline{};
+#endif
+};
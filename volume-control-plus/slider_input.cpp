@@ -0,0 +1,73 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "slider_input.h"
+
+int SliderInput::Clamp(int position)
+{
+    if (position < minPosition) return minPosition;
+    if (position > maxPosition) return maxPosition;
+
+    return position;
+}
+
+void SliderInput::SetPending(int position)
+{
+    // A previous value was never written, it gets replaced by this one
+    if (hasPending)
+    {
+        ++coalescedCount;
+    }
+
+    pendingPosition = Clamp(position);
+    hasPending = true;
+}
+
+void SliderInput::OnThumbTrack(int position)
+{
+    owner = Owner::User;
+    SetPending(position);
+}
+
+void SliderInput::OnStep(int position)
+{
+    SetPending(position);
+}
+
+void SliderInput::OnEndTrack(int position)
+{
+    SetPending(position);
+
+    // Hand the slider back to the system once the final value is written
+    owner = Owner::System;
+}
+
+bool SliderInput::TakePendingWrite(float& volume)
+{
+    if (!hasPending)
+    {
+        return false;
+    }
+
+    hasPending = false;
+    volume = static_cast<float>(pendingPosition) / static_cast<float>(maxPosition);
+
+    return true;
+}
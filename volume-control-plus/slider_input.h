@@ -0,0 +1,76 @@
+// Copyright (c) 2024 Wildan R Wijanarko
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Decides who owns the volume slider: the user (while they are dragging it,
+// scrolling it or using the keyboard on it) or the system (the rest of the time).
+// It has no Windows dependencies, the window procedure feeds it trackbar
+// notifications and the main loop asks it once per frame what to do.
+class SliderInput
+{
+public:
+    // Who the slider value currently belongs to
+    enum class Owner { System, User };
+
+    // Slider range, matches TBM_SETRANGE in WinMain
+    static constexpr int minPosition{0};
+    static constexpr int maxPosition{100};
+
+    // The user is dragging the thumb (TB_THUMBTRACK). The slider stays user
+    // owned until OnEndTrack.
+    void OnThumbTrack(int position);
+
+    // A single step from the keyboard, mouse wheel or a channel click
+    // (TB_LINEUP, TB_PAGEDOWN, TB_THUMBPOSITION, ...). Wheel steps are not
+    // followed by TB_ENDTRACK, so ownership doesn't change: the step is
+    // written and then the slider follows the system again.
+    void OnStep(int position);
+
+    // The user let go of the slider (TB_ENDTRACK)
+    void OnEndTrack(int position);
+
+    // Returns true and the volume to write if the user changed the slider since
+    // the last call. Rapid updates are coalesced, so this yields at most one
+    // backend write per frame no matter how many notifications arrived.
+    bool TakePendingWrite(float& volume);
+
+    // Returns true if the slider should follow the system volume this frame
+    bool FollowsSystem() const { return owner == Owner::System && !hasPending; }
+
+    Owner GetOwner() const { return owner; }
+
+    // Number of notifications folded into a write that was never issued
+    unsigned long GetCoalescedCount() const { return coalescedCount; }
+
+private:
+    static int Clamp(int position);
+
+    // Remember the latest position, replacing one that was never written
+    void SetPending(int position);
+
+    Owner owner{Owner::System};
+
+    // Latest position the user asked for
+    int pendingPosition{0};
+    bool hasPending{false};
+
+    unsigned long coalescedCount{0};
+};